@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include <memory>
+#include <functional>
+
+/**
+ * @brief Aggregates (key, move) pairs to win/draw/loss counts using an external merge sort.
+ * 
+ * Records are collected in a memory bounded buffer. Every time it is full, it gets sorted,
+ * aggregated and written to a temporary run file. All runs are merged in the end, so the
+ * amount of memory used is independent of the input size.
+ */
+class BookAggregator{
+    public:
+        struct Record{
+            uint64_t key = 0;
+            uint16_t move = 0;
+            uint32_t wins = 0;
+            uint32_t draws = 0;
+            uint32_t losses = 0;
+
+            bool hasSameKeyAndMove(Record const& other) const{
+                return key == other.key && move == other.move;
+            }
+            bool operator < (Record const& other) const{
+                if (key != other.key) return key < other.key;
+                return move < other.move;
+            }
+            void accumulate(Record const& other){
+                wins += other.wins;
+                draws += other.draws;
+                losses += other.losses;
+            }
+        };
+
+        enum class Outcome{
+            Win,
+            Draw,
+            Loss,
+        };
+
+        /**
+         * @param memoryLimit the maximum number of bytes to use for buffering records
+         */
+        BookAggregator(size_t memoryLimit);
+
+        /**
+         * @brief Add a single occurrence of a move.
+         * 
+         * @param key the position the move was played in
+         * @param move the encoded move
+         * @param outcome the outcome for the side that played the move
+         */
+        void add(uint64_t key, uint16_t move, Outcome outcome);
+
+        /**
+         * @brief Merge all records and call callback once for every distinct (key, move) in ascending order.
+         * 
+         * @param callback the function to call
+         */
+        void finish(std::function<void(Record const&)> callback);
+
+        constexpr size_t getNumRuns() const { return runs.size(); }
+
+    private:
+        void sortAndAggregateBuffer();
+        void writeRun();
+
+        using UniqueFile = std::unique_ptr<FILE, decltype(&fclose)>;
+
+        std::vector<Record> buffer;
+        size_t maxBufferedRecords;
+        std::vector<UniqueFile> runs;
+};
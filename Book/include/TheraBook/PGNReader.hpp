@@ -0,0 +1,39 @@
+#pragma once
+
+#include <istream>
+#include <string>
+#include <vector>
+#include <map>
+
+/**
+ * @brief A minimal streaming reader for PGN files.
+ * 
+ * Comments, variations, NAGs and move numbers are skipped, so only the tags and
+ * the SAN moves of the main line remain.
+ */
+class PGNReader{
+    public:
+        struct Game{
+            std::map<std::string, std::string> tags;
+            std::vector<std::string> moves;
+            std::string result;
+        };
+
+        PGNReader(std::istream& stream): stream(stream){}
+
+        /**
+         * @brief Read the next game.
+         * 
+         * @param game the game to fill
+         * @return bool was a game read
+         */
+        bool readGame(Game& game);
+
+    private:
+        void readTag(Game& game);
+        void skipUntil(char end);
+        void skipVariation();
+        std::string readToken();
+
+        std::istream& stream;
+};
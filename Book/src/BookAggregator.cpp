@@ -0,0 +1,102 @@
+#include "TheraBook/BookAggregator.hpp"
+
+#include <algorithm>
+#include <queue>
+#include <stdexcept>
+
+BookAggregator::BookAggregator(size_t memoryLimit){
+    maxBufferedRecords = std::max<size_t>(memoryLimit / sizeof(Record), 1024);
+    buffer.reserve(maxBufferedRecords);
+}
+
+void BookAggregator::add(uint64_t key, uint16_t move, Outcome outcome){
+    Record& record = buffer.emplace_back();
+    record.key = key;
+    record.move = move;
+    switch (outcome){
+        case Outcome::Win:  record.wins = 1; break;
+        case Outcome::Draw: record.draws = 1; break;
+        case Outcome::Loss: record.losses = 1; break;
+    }
+
+    if (buffer.size() >= maxBufferedRecords){
+        sortAndAggregateBuffer();
+        // only spill if aggregation didn't free enough memory
+        if (buffer.size() >= maxBufferedRecords / 2)
+            writeRun();
+    }
+}
+
+void BookAggregator::sortAndAggregateBuffer(){
+    std::sort(buffer.begin(), buffer.end());
+
+    size_t out = 0;
+    for (size_t i=1; i<buffer.size(); i++){
+        if (buffer.at(out).hasSameKeyAndMove(buffer.at(i)))
+            buffer.at(out).accumulate(buffer.at(i));
+        else
+            buffer.at(++out) = buffer.at(i);
+    }
+    if (buffer.size())
+        buffer.resize(out+1);
+}
+
+void BookAggregator::writeRun(){
+    UniqueFile file(std::tmpfile(), fclose);
+    if (!file) throw std::runtime_error("Unable to create temporary run file");
+
+    if (std::fwrite(buffer.data(), sizeof(Record), buffer.size(), file.get()) != buffer.size())
+        throw std::runtime_error("Unable to write temporary run file");
+    std::rewind(file.get());
+
+    runs.push_back(std::move(file));
+    buffer.clear();
+}
+
+void BookAggregator::finish(std::function<void(Record const&)> callback){
+    sortAndAggregateBuffer();
+
+    struct RunHead{
+        Record record;
+        size_t runIndex;
+
+        bool operator < (RunHead const& other) const{
+            // std::priority_queue is a max heap
+            return other.record < record;
+        }
+    };
+    std::priority_queue<RunHead> heads;
+
+    const auto readNext = [&](size_t runIndex){
+        RunHead head;
+        head.runIndex = runIndex;
+        if (std::fread(&head.record, sizeof(Record), 1, runs.at(runIndex).get()) == 1)
+            heads.push(head);
+    };
+
+    // write the remaining records as a run too, to keep merging uniform
+    if (buffer.size()) writeRun();
+
+    for (size_t i=0; i<runs.size(); i++){
+        readNext(i);
+    }
+
+    bool hasCurrent = false;
+    Record current;
+    while (!heads.empty()){
+        RunHead head = heads.top();
+        heads.pop();
+        readNext(head.runIndex);
+
+        if (hasCurrent && current.hasSameKeyAndMove(head.record)){
+            current.accumulate(head.record);
+            continue;
+        }
+        if (hasCurrent) callback(current);
+        current = head.record;
+        hasCurrent = true;
+    }
+    if (hasCurrent) callback(current);
+
+    runs.clear();
+}
@@ -0,0 +1,105 @@
+#include "TheraBook/PGNReader.hpp"
+
+#include <cctype>
+
+static bool isResult(std::string const& token){
+    return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+}
+
+bool PGNReader::readGame(Game& game){
+    game.tags.clear();
+    game.moves.clear();
+    game.result.clear();
+
+    bool hasContent = false;
+    int c;
+    while ((c = stream.peek()) != EOF){
+        if (std::isspace(c)){
+            stream.get();
+        }
+        else if (c == '['){
+            // a new tag section starts a new game
+            if (game.moves.size()) return true;
+            readTag(game);
+            hasContent = true;
+        }
+        else if (c == '{'){
+            skipUntil('}');
+        }
+        else if (c == ';' || c == '%'){
+            skipUntil('\n');
+        }
+        else if (c == '('){
+            skipVariation();
+        }
+        else{
+            std::string token = readToken();
+            if (token.empty()){
+                // unknown character
+                stream.get();
+                continue;
+            }
+            hasContent = true;
+
+            if (isResult(token)){
+                game.result = token;
+                return true;
+            }
+            if (token.front() == '$') continue;
+
+            // remove move numbers ("12." and "12...")
+            const size_t lastDot = token.find_last_of('.');
+            if (lastDot != std::string::npos) token.erase(0, lastDot+1);
+            if (token.empty()) continue;
+            game.moves.push_back(token);
+        }
+    }
+    return hasContent;
+}
+
+void PGNReader::readTag(Game& game){
+    stream.get(); // consume '['
+
+    std::string name;
+    while (stream.peek() != EOF && !std::isspace(stream.peek()) && stream.peek() != ']'){
+        name += stream.get();
+    }
+
+    std::string value;
+    while (stream.peek() != EOF && stream.peek() != '"' && stream.peek() != ']') stream.get();
+    if (stream.peek() == '"'){
+        stream.get();
+        while (stream.peek() != EOF && stream.peek() != '"'){
+            char c = stream.get();
+            if (c == '\\' && stream.peek() != EOF) c = stream.get();
+            value += c;
+        }
+    }
+    skipUntil(']');
+
+    game.tags[name] = value;
+}
+
+void PGNReader::skipUntil(char end){
+    int c;
+    while ((c = stream.get()) != EOF && c != end);
+}
+
+void PGNReader::skipVariation(){
+    int depth = 0;
+    int c;
+    while ((c = stream.get()) != EOF){
+        if (c == '(') depth++;
+        else if (c == ')' && --depth == 0) return;
+        else if (c == '{') skipUntil('}');
+    }
+}
+
+std::string PGNReader::readToken(){
+    std::string token;
+    int c;
+    while ((c = stream.peek()) != EOF && !std::isspace(c) && std::string("[]{}();").find(c) == std::string::npos){
+        token += stream.get();
+    }
+    return token;
+}
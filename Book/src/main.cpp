@@ -0,0 +1,190 @@
+#include "Thera/Board.hpp"
+#include "Thera/Move.hpp"
+#include "Thera/OpeningBook.hpp"
+#include "Thera/Utils/ChessTerms.hpp"
+#include "Thera/Utils/GitInfo.hpp"
+
+#include "TheraBook/PGNReader.hpp"
+#include "TheraBook/BookAggregator.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <algorithm>
+
+struct Options{
+    std::string outputPath;
+    std::vector<std::string> inputPaths;
+    int maxPly = 30;
+    size_t memoryLimitMB = 256;
+    uint32_t minGames = 1;
+};
+
+void printHelp(std::string const& argv0){
+    std::cout << "Usage: " << argv0 << " [options] [output.bin] [input.pgn]...\n" <<
+R"(Builds an opening book from PGN files.
+
+Options:
+    -h/--help           Print this helping text
+    --max-ply [n]       Only use the first n plies of every game (default: 30)
+    --memory [MB]       Memory used for aggregation before spilling to disk (default: 256)
+    --min-games [n]     Only keep moves played in at least n games (default: 1)
+    --version           Get the current version (git hash) and exit.
+)";
+}
+
+static BookAggregator::Outcome getOutcome(std::string const& result, Thera::PieceColor color){
+    if (result == "1/2-1/2") return BookAggregator::Outcome::Draw;
+    const bool whiteWon = result == "1-0";
+    return (whiteWon == (color == Thera::PieceColor::White)) ? BookAggregator::Outcome::Win : BookAggregator::Outcome::Loss;
+}
+
+/**
+ * @brief Add all moves of a game to the aggregator. Nothing is added if any move can't be parsed.
+ * 
+ * @return bool could all moves be parsed
+ */
+static bool addGame(PGNReader::Game const& game, Options const& options, Thera::Board& board, BookAggregator& aggregator){
+    if (game.result != "1-0" && game.result != "0-1" && game.result != "1/2-1/2") return true;
+
+    struct Ply{
+        uint64_t key;
+        uint16_t move;
+        BookAggregator::Outcome outcome;
+    };
+    std::vector<Ply> plies;
+
+    try{
+        board.loadFromFEN(game.tags.contains("FEN") ? game.tags.at("FEN") : Thera::Utils::startingFEN);
+
+        const int numPlies = std::min<int>(options.maxPly, game.moves.size());
+        for (int i=0; i<numPlies; i++){
+            const Thera::Move move = Thera::Move::fromSAN(game.moves.at(i), board);
+            plies.push_back({board.getCurrentHash(), move.encode(), getOutcome(game.result, board.getColorToMove())});
+            board.applyMove(move);
+        }
+    }
+    catch(std::invalid_argument const& e){
+        std::cerr << e.what() << "\n";
+        return false;
+    }
+
+    for (auto const& ply : plies){
+        aggregator.add(ply.key, ply.move, ply.outcome);
+    }
+    return true;
+}
+
+int main(int argc, const char** argv){
+    Options options;
+
+    int i = 0;
+    while (i+1 < argc){
+        std::string arg = argv[++i];
+        const auto nextArgument = [&]() -> std::string{
+            if (i+1 >= argc) throw std::invalid_argument("Missing value for \"" + arg + "\" option");
+            return argv[++i];
+        };
+
+        try{
+            if (arg == "-h" || arg == "--help"){
+                printHelp(argv[0]);
+                return 0;
+            }
+            else if (arg == "--max-ply"){
+                options.maxPly = std::stoi(nextArgument());
+            }
+            else if (arg == "--memory"){
+                options.memoryLimitMB = std::stoul(nextArgument());
+            }
+            else if (arg == "--min-games"){
+                options.minGames = std::stoul(nextArgument());
+            }
+            else if (arg == "--version"){
+                std::cout << "Commit " << Thera::Utils::GitInfo::hash;
+                if (Thera::Utils::GitInfo::isDirty)
+                    std::cout << " + local changes";
+                std::cout << "\n";
+                return 0;
+            }
+            else if (options.outputPath.empty()){
+                options.outputPath = arg;
+            }
+            else{
+                options.inputPaths.push_back(arg);
+            }
+        }
+        catch(std::exception const& e){
+            std::cout << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    if (options.outputPath.empty() || options.inputPaths.empty()){
+        printHelp(argv[0]);
+        return 1;
+    }
+
+    Thera::Board board;
+    BookAggregator aggregator(options.memoryLimitMB * 1024 * 1024);
+
+    uint64_t numGames = 0, numInvalidGames = 0;
+    for (auto const& path : options.inputPaths){
+        std::ifstream file(path);
+        if (!file.is_open()){
+            std::cout << "Unable to open \"" << path << "\"\n";
+            return 1;
+        }
+
+        PGNReader reader(file);
+        PGNReader::Game game;
+        while (reader.readGame(game)){
+            numGames++;
+            if (!addGame(game, options, board, aggregator))
+                numInvalidGames++;
+        }
+    }
+
+    std::ofstream output(options.outputPath, std::ios::binary | std::ios::trunc);
+    if (!output.is_open()){
+        std::cout << "Unable to open \"" << options.outputPath << "\"\n";
+        return 1;
+    }
+
+    // all moves of a position are collected to scale their weights together
+    std::vector<BookAggregator::Record> currentPosition;
+    uint64_t numEntries = 0;
+    const auto writePosition = [&](){
+        uint32_t maxScore = 0;
+        for (auto const& record : currentPosition){
+            maxScore = std::max(maxScore, 2*record.wins + record.draws);
+        }
+        const double scale = maxScore > UINT16_MAX ? double(UINT16_MAX) / maxScore : 1.0;
+
+        for (auto const& record : currentPosition){
+            Thera::OpeningBook::Entry entry;
+            entry.key = record.key;
+            entry.move = record.move;
+            entry.weight = (2*record.wins + record.draws) * scale;
+            if (entry.weight == 0) continue;
+
+            Thera::OpeningBook::writeEntry(output, entry);
+            numEntries++;
+        }
+        currentPosition.clear();
+    };
+
+    const size_t numRuns = aggregator.getNumRuns();
+    aggregator.finish([&](BookAggregator::Record const& record){
+        if (record.wins + record.draws + record.losses < options.minGames) return;
+        if (currentPosition.size() && currentPosition.back().key != record.key)
+            writePosition();
+        currentPosition.push_back(record);
+    });
+    writePosition();
+
+    std::cout << "Read " << numGames << " games (" << numInvalidGames << " invalid), merged " << numRuns << " runs and wrote " << numEntries << " entries.\n";
+    return 0;
+}
@@ -12,7 +12,9 @@
 #include "Thera/Utils/GitInfo.hpp"
 
 #include "Thera/perft.hpp"
+#include "Thera/ThreadPool.hpp"
 #include "Thera/search.hpp"
+#include "Thera/TranspositionTable.hpp"
 
 #include "ANSI/ANSI.hpp"
 
@@ -113,13 +115,13 @@ static void printBoard(Thera::Board& board, Thera::MoveGenerator& generator, std
 				break;
 			case 2:
 				std::cout << "          ";
-				std::cout << setConditionalColor(board.getCurrentState().canWhiteCastleLeft, ANSI::Background) << "[Q]";
+				std::cout << setConditionalColor(board.getCurrentState().canWhiteCastleLeft(), ANSI::Background) << "[Q]";
 				std::cout << ANSI::reset() << " ";
-				std::cout << setConditionalColor(board.getCurrentState().canWhiteCastleRight, ANSI::Background) << "[K]";
+				std::cout << setConditionalColor(board.getCurrentState().canWhiteCastleRight(), ANSI::Background) << "[K]";
 				std::cout << ANSI::reset() << " ";
-				std::cout << setConditionalColor(board.getCurrentState().canBlackCastleLeft, ANSI::Background) << "[Q]";
+				std::cout << setConditionalColor(board.getCurrentState().canBlackCastleLeft(), ANSI::Background) << "[Q]";
 				std::cout << ANSI::reset() << " ";
-				std::cout << setConditionalColor(board.getCurrentState().canBlackCastleRight, ANSI::Background) << "[K]";
+				std::cout << setConditionalColor(board.getCurrentState().canBlackCastleRight(), ANSI::Background) << "[K]";
 
 				break;
 			case 3:
@@ -519,6 +521,7 @@ static void setBitboardHighlight(Options const& options, Thera::Board const& boa
 	Thera::Bitboard bitboard;
 
 	generator.generateAttackData(board);
+	generator.generateAttackMaps(board);
 	switch(options.selectedBitboard){
 		case BitboardSelection::AllPieces:
 			if (options.shownPieceBitboard.type == Thera::PieceType::None)
@@ -717,6 +720,8 @@ int playMode(Options& options){
 	options.selectedBitboard = BitboardSelection::None;
 
 	Thera::MoveGenerator generator;
+	Thera::TranspositionTable transpositionTable;
+	Thera::ThreadPool perftPool(std::max(1u, std::thread::hardware_concurrency()));
 
 	std::string message =  	"Enter move or type 'exit'.\n"
 							"Change your move by typing 'change'.\n"
@@ -733,7 +738,7 @@ int playMode(Options& options){
 			}
 			if (computerColor == board.getColorToMove() && lastOp != MoveInputResult::UndoMove){
 				auto const start = std::chrono::high_resolution_clock::now();
-				auto moves = Thera::search(board, generator, options.autoplayDepth, options.autoplaySearchTime, std::atomic<bool>(false), searchIterationEndCallback);
+				auto moves = Thera::search(board, generator, transpositionTable, options.autoplayDepth, options.autoplaySearchTime, std::atomic<bool>(false), searchIterationEndCallback);
 				auto const end = std::chrono::high_resolution_clock::now();
 				std::chrono::duration<float> duration = end - start;
 				if (moves.moves.size() == 0){
@@ -805,7 +810,7 @@ int playMode(Options& options){
 		}
 	else if (userInput.op == MoveInputResult::Search){
 			auto const start = std::chrono::high_resolution_clock::now();
-			auto moves = Thera::search(board, generator, userInput.perftDepth, userInput.maxSearchTime, std::atomic<bool>(false), searchIterationEndCallback);
+			auto moves = Thera::search(board, generator, transpositionTable, userInput.perftDepth, userInput.maxSearchTime, std::atomic<bool>(false), searchIterationEndCallback);
 			auto const end = std::chrono::high_resolution_clock::now();
 			std::chrono::duration<float> duration = end - start;
 
@@ -847,7 +852,7 @@ int playMode(Options& options){
 			Thera::PerftResult result;
     		const auto start = std::chrono::high_resolution_clock::now();
 			if (userInput.perftInstrumented) result = Thera::perft_instrumented(board, generator, userInput.perftDepth, true);
-			else result = Thera::perft(board, generator, userInput.perftDepth, true);
+			else result = Thera::perft(board, userInput.perftDepth, true, perftPool);
     		const auto stop = std::chrono::high_resolution_clock::now();
 			std::chrono::duration<double> duration = stop-start;
 
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "TheraPerftDist/WorkerProcess.hpp"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <optional>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief A single perft run to be executed by a worker.
+ */
+struct WorkItem{
+    std::string fen;
+    int depth;
+};
+
+/**
+ * @brief Distributes work items over worker processes.
+ * 
+ * Every worker gets one item at a time. Items of workers that crash, time out or answer
+ * garbage are given to the next free worker, after which the failed worker is restarted.
+ * Workers failing too often in a row are dropped.
+ * 
+ * Protocol (one line per message):
+ *     coordinator -> worker: [item id] [depth] [fen]
+ *     worker -> coordinator: [item id] [number of nodes]
+ */
+class Coordinator{
+    public:
+        struct Options{
+            std::string workerCommand;
+            int numWorkers = 1;
+            int maxRetries = 3;
+            std::optional<std::chrono::seconds> timeout;
+        };
+
+        struct Statistics{
+            uint64_t numRetries = 0;
+            uint64_t numWorkerRestarts = 0;
+            uint64_t numDroppedWorkers = 0;
+        };
+
+        Coordinator(Options const& options);
+
+        /**
+         * @brief Run all items. Throws std::runtime_error if an item failed more than the allowed number of retries.
+         * 
+         * @param items the items to run
+         * @return std::vector<uint64_t> the number of nodes for every item
+         */
+        std::vector<uint64_t> run(std::vector<WorkItem> const& items);
+
+        constexpr Statistics const& getStatistics() const { return statistics; }
+
+    private:
+        struct Worker{
+            std::unique_ptr<WorkerProcess> process;
+            std::optional<size_t> currentItem;
+            std::chrono::steady_clock::time_point itemStart;
+            int numConsecutiveFailures = 0;
+        };
+
+        /**
+         * @brief Kill a worker, requeue its item and start a new one or drop the worker.
+         */
+        void restartWorker(Worker& worker, std::vector<size_t>& queue, std::vector<int>& numFailures);
+
+        Options options;
+        Statistics statistics;
+        std::vector<Worker> workers;
+};
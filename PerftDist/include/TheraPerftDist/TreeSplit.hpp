@@ -0,0 +1,34 @@
+#pragma once
+
+#include "TheraPerftDist/Coordinator.hpp"
+
+#include "Thera/Board.hpp"
+#include "Thera/Move.hpp"
+#include "Thera/MoveGenerator.hpp"
+
+#include <vector>
+#include <map>
+#include <cstdint>
+
+/**
+ * @brief A perft tree split into independent work items.
+ */
+struct TreeSplit{
+    std::vector<Thera::Move> rootMoves;
+    std::vector<WorkItem> items;
+    // for every item: root move index -> number of paths reaching the item's position
+    std::vector<std::map<size_t, uint64_t>> occurrences;
+};
+
+/**
+ * @brief Split a perft tree at a given ply.
+ * 
+ * Positions reached by transpositions are only included once and weighted by their number of paths.
+ * 
+ * @param board the root position
+ * @param generator the move generator
+ * @param depth the total perft depth
+ * @param splitDepth the ply at which the tree is split (1 <= splitDepth < depth)
+ * @return TreeSplit the work items
+ */
+TreeSplit splitTree(Thera::Board& board, Thera::MoveGenerator& generator, int depth, int splitDepth);
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+/**
+ * @brief A worker running as a child process, connected through pipes.
+ * 
+ * The worker is started using "/bin/sh -c", so the command may also reach other
+ * machines (for example using ssh), as long as it forwards stdin and stdout.
+ */
+class WorkerProcess{
+    public:
+        /**
+         * @brief Start the worker. Throws std::runtime_error if that fails.
+         * 
+         * @param command the shell command starting the worker
+         */
+        WorkerProcess(std::string const& command);
+        ~WorkerProcess();
+
+        WorkerProcess(WorkerProcess const&) = delete;
+        WorkerProcess& operator = (WorkerProcess const&) = delete;
+
+        /**
+         * @brief Send a line to the worker.
+         * 
+         * @param line the line without the trailing newline
+         * @return bool could the line be written
+         */
+        bool send(std::string const& line);
+
+        /**
+         * @brief Read all available output. Should only be called once the output is readable.
+         * 
+         * @param lines complete lines are appended to this
+         * @return bool false if the worker closed its output
+         */
+        bool receive(std::vector<std::string>& lines);
+
+        /**
+         * @brief Terminate the worker and wait for it to exit.
+         */
+        void kill();
+
+        int getOutputFD() const { return outputFD; }
+
+    private:
+        pid_t pid = -1;
+        int inputFD = -1;
+        int outputFD = -1;
+        std::string buffer;
+};
@@ -0,0 +1,118 @@
+#include "TheraPerftDist/Coordinator.hpp"
+
+#include <stdexcept>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <cerrno>
+
+#include <poll.h>
+#include <signal.h>
+
+Coordinator::Coordinator(Options const& options): options(options){
+    if (options.numWorkers < 1) throw std::invalid_argument("At least one worker is needed");
+
+    // writing to crashed workers should fail instead of terminating the coordinator
+    signal(SIGPIPE, SIG_IGN);
+}
+
+void Coordinator::restartWorker(Worker& worker, std::vector<size_t>& queue, std::vector<int>& numFailures){
+    if (worker.currentItem.has_value()){
+        const size_t item = worker.currentItem.value();
+        if (++numFailures.at(item) > options.maxRetries)
+            throw std::runtime_error("Work item " + std::to_string(item) + " failed " + std::to_string(numFailures.at(item)) + " times");
+        queue.push_back(item);
+        statistics.numRetries++;
+        worker.currentItem.reset();
+    }
+
+    if (++worker.numConsecutiveFailures > options.maxRetries){
+        worker.process.reset();
+        statistics.numDroppedWorkers++;
+        if (statistics.numDroppedWorkers == workers.size())
+            throw std::runtime_error("All workers failed");
+        return;
+    }
+
+    worker.process = std::make_unique<WorkerProcess>(options.workerCommand);
+    statistics.numWorkerRestarts++;
+}
+
+std::vector<uint64_t> Coordinator::run(std::vector<WorkItem> const& items){
+    std::vector<uint64_t> results(items.size(), 0);
+    std::vector<int> numFailures(items.size(), 0);
+    size_t numDone = 0;
+
+    // items are taken from the back
+    std::vector<size_t> queue(items.size());
+    for (size_t i=0; i<items.size(); i++){
+        queue.at(i) = items.size()-1-i;
+    }
+
+    workers.clear();
+    workers.resize(options.numWorkers);
+    statistics = {};
+    for (auto& worker : workers){
+        worker.process = std::make_unique<WorkerProcess>(options.workerCommand);
+    }
+
+    while (numDone < items.size()){
+        for (auto& worker : workers){
+            if (!worker.process || worker.currentItem.has_value() || queue.empty()) continue;
+
+            const size_t item = queue.back();
+            queue.pop_back();
+            worker.currentItem = item;
+            worker.itemStart = std::chrono::steady_clock::now();
+            // failed sends show up as a closed output below
+            worker.process->send(std::to_string(item) + " " + std::to_string(items.at(item).depth) + " " + items.at(item).fen);
+        }
+
+        std::vector<pollfd> pollFDs;
+        for (auto const& worker : workers){
+            // negative file descriptors are ignored by poll
+            pollFDs.push_back({worker.process ? worker.process->getOutputFD() : -1, POLLIN, 0});
+        }
+        const int pollTimeoutMS = options.timeout.has_value() ? 1000 : -1;
+        if (poll(pollFDs.data(), pollFDs.size(), pollTimeoutMS) < 0 && errno != EINTR)
+            throw std::runtime_error("Unable to wait for workers");
+
+        const auto now = std::chrono::steady_clock::now();
+        for (size_t i=0; i<workers.size(); i++){
+            Worker& worker = workers.at(i);
+            if (!worker.process) continue;
+
+            if (pollFDs.at(i).revents == 0){
+                if (options.timeout.has_value() && worker.currentItem.has_value() && now - worker.itemStart > options.timeout.value()){
+                    std::cerr << "Worker " << i << " timed out.\n";
+                    restartWorker(worker, queue, numFailures);
+                }
+                continue;
+            }
+
+            std::vector<std::string> lines;
+            bool isHealthy = worker.process->receive(lines);
+            for (auto const& line : lines){
+                std::stringstream lineStream(line);
+                size_t item;
+                uint64_t numNodes;
+                if (!(lineStream >> item >> numNodes) || worker.currentItem != item){
+                    isHealthy = false;
+                    break;
+                }
+                results.at(item) = numNodes;
+                worker.currentItem.reset();
+                worker.numConsecutiveFailures = 0;
+                numDone++;
+            }
+
+            if (!isHealthy){
+                std::cerr << "Worker " << i << " failed.\n";
+                restartWorker(worker, queue, numFailures);
+            }
+        }
+    }
+
+    workers.clear();
+    return results;
+}
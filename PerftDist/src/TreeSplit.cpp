@@ -0,0 +1,48 @@
+#include "TheraPerftDist/TreeSplit.hpp"
+
+#include <unordered_map>
+#include <stdexcept>
+
+// the move counters don't change the perft result, so they are left out when detecting transpositions
+static std::string getPositionKey(std::string const& fen){
+    size_t end = fen.size();
+    for (int i=0; i<2; i++){
+        end = fen.rfind(' ', end-1);
+    }
+    return fen.substr(0, end);
+}
+
+static void splitTreeRecursive(Thera::Board& board, Thera::MoveGenerator& generator, int depth, int pliesLeft, size_t rootMoveIndex, TreeSplit& split, std::unordered_map<std::string, size_t>& itemIndices){
+    if (pliesLeft == 0){
+        const std::string fen = board.storeToFEN();
+        auto [it, isNew] = itemIndices.emplace(getPositionKey(fen), split.items.size());
+        if (isNew){
+            split.items.push_back({fen, depth});
+            split.occurrences.emplace_back();
+        }
+        split.occurrences.at(it->second)[rootMoveIndex]++;
+        return;
+    }
+
+    for (auto const& move : generator.generateAllMoves(board)){
+        board.applyMove(move);
+        splitTreeRecursive(board, generator, depth, pliesLeft-1, rootMoveIndex, split, itemIndices);
+        board.rewindMove();
+    }
+}
+
+TreeSplit splitTree(Thera::Board& board, Thera::MoveGenerator& generator, int depth, int splitDepth){
+    if (splitDepth < 1 || splitDepth >= depth) throw std::invalid_argument("The split depth has to be between 1 and depth-1");
+
+    TreeSplit split;
+    std::unordered_map<std::string, size_t> itemIndices;
+
+    split.rootMoves = generator.generateAllMoves(board);
+    for (size_t i=0; i<split.rootMoves.size(); i++){
+        board.applyMove(split.rootMoves.at(i));
+        splitTreeRecursive(board, generator, depth-splitDepth, splitDepth-1, i, split, itemIndices);
+        board.rewindMove();
+    }
+
+    return split;
+}
@@ -0,0 +1,83 @@
+#include "TheraPerftDist/WorkerProcess.hpp"
+
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+
+WorkerProcess::WorkerProcess(std::string const& command){
+    int toWorker[2], fromWorker[2];
+    if (pipe(toWorker) != 0)
+        throw std::runtime_error(std::string("Unable to create pipe: ") + strerror(errno));
+    if (pipe(fromWorker) != 0){
+        close(toWorker[0]);
+        close(toWorker[1]);
+        throw std::runtime_error(std::string("Unable to create pipe: ") + strerror(errno));
+    }
+
+    pid = fork();
+    if (pid == -1){
+        for (int fd : {toWorker[0], toWorker[1], fromWorker[0], fromWorker[1]}) close(fd);
+        throw std::runtime_error(std::string("Unable to start worker: ") + strerror(errno));
+    }
+
+    if (pid == 0){
+        dup2(toWorker[0], STDIN_FILENO);
+        dup2(fromWorker[1], STDOUT_FILENO);
+        for (int fd : {toWorker[0], toWorker[1], fromWorker[0], fromWorker[1]}) close(fd);
+
+        execl("/bin/sh", "sh", "-c", command.c_str(), nullptr);
+        _exit(127);
+    }
+
+    close(toWorker[0]);
+    close(fromWorker[1]);
+    inputFD = toWorker[1];
+    outputFD = fromWorker[0];
+}
+
+WorkerProcess::~WorkerProcess(){
+    kill();
+}
+
+bool WorkerProcess::send(std::string const& line){
+    const std::string data = line + "\n";
+    size_t written = 0;
+    while (written < data.size()){
+        const ssize_t result = write(inputFD, data.data() + written, data.size() - written);
+        if (result < 0 && errno == EINTR) continue;
+        if (result <= 0) return false;
+        written += result;
+    }
+    return true;
+}
+
+bool WorkerProcess::receive(std::vector<std::string>& lines){
+    char chunk[4096];
+    ssize_t numRead;
+    do{
+        numRead = read(outputFD, chunk, sizeof(chunk));
+    } while (numRead < 0 && errno == EINTR);
+    if (numRead <= 0) return false;
+
+    buffer.append(chunk, numRead);
+    size_t lineEnd;
+    while ((lineEnd = buffer.find('\n')) != std::string::npos){
+        lines.push_back(buffer.substr(0, lineEnd));
+        buffer.erase(0, lineEnd+1);
+    }
+    return true;
+}
+
+void WorkerProcess::kill(){
+    if (pid <= 0) return;
+
+    close(inputFD);
+    close(outputFD);
+    ::kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+    pid = -1;
+}
@@ -0,0 +1,188 @@
+#include "Thera/Board.hpp"
+#include "Thera/Move.hpp"
+#include "Thera/MoveGenerator.hpp"
+#include "Thera/perft.hpp"
+#include "Thera/Utils/ChessTerms.hpp"
+#include "Thera/Utils/GitInfo.hpp"
+
+#include "TheraPerftDist/Coordinator.hpp"
+#include "TheraPerftDist/TreeSplit.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <filesystem>
+#include <chrono>
+#include <optional>
+
+struct Options{
+    std::string fen = Thera::Utils::startingFEN;
+    int depth = 0;
+    int splitDepth = 2;
+    Coordinator::Options coordinator;
+    bool isWorker = false;
+    std::optional<int> crashAfter;
+};
+
+void printHelp(std::string const& argv0){
+    std::cout << "Usage: " << argv0 << " [options] [depth]\n" <<
+R"(Runs perft by splitting the tree into work items that are run by worker processes.
+
+Options:
+    -h/--help               Print this helping text
+    --fen [fen]             The position to run perft for (default: starting position)
+    --split-depth [n]       The ply at which the tree is split into work items (default: 2)
+    --workers [n]           The number of worker processes (default: 1)
+    --worker-command [cmd]  The shell command starting a worker (default: this program with --worker)
+                            Remote machines can be used with commands like "ssh host thera-perft-dist --worker".
+    --retries [n]           How often a single work item may fail (default: 3)
+    --timeout [s]           Consider a worker failed if a single item takes longer than this
+    --worker                Run as a worker, reading work items from stdin
+    --crash-after [n]       Only for workers: exit after n items. Used to test retrying.
+    --version               Get the current version (git hash) and exit.
+)";
+}
+
+static int runWorker(Options const& options){
+    Thera::Board board;
+    Thera::MoveGenerator generator;
+
+    int numItems = 0;
+    std::string line;
+    while (std::getline(std::cin, line)){
+        if (options.crashAfter.has_value() && numItems++ >= options.crashAfter.value()) return 1;
+
+        std::stringstream lineStream(line);
+        std::string item;
+        int depth;
+        std::string fen;
+        lineStream >> item >> depth;
+        std::getline(lineStream >> std::ws, fen);
+
+        board.loadFromFEN(fen);
+        const auto result = Thera::perft(board, generator, depth, true);
+        std::cout << item << " " << result.numNodesSearched << std::endl;
+    }
+    return 0;
+}
+
+static std::string getDefaultWorkerCommand(const char* argv0){
+    std::error_code error;
+    auto path = std::filesystem::read_symlink("/proc/self/exe", error);
+    if (error) path = std::filesystem::absolute(argv0);
+    return "'" + path.string() + "' --worker";
+}
+
+int main(int argc, const char** argv){
+    Options options;
+
+    int i = 0;
+    while (i+1 < argc){
+        std::string arg = argv[++i];
+        const auto nextArgument = [&]() -> std::string{
+            if (i+1 >= argc) throw std::invalid_argument("Missing value for \"" + arg + "\" option");
+            return argv[++i];
+        };
+
+        try{
+            if (arg == "-h" || arg == "--help"){
+                printHelp(argv[0]);
+                return 0;
+            }
+            else if (arg == "--fen"){
+                options.fen = nextArgument();
+            }
+            else if (arg == "--split-depth"){
+                options.splitDepth = std::stoi(nextArgument());
+            }
+            else if (arg == "--workers"){
+                options.coordinator.numWorkers = std::stoi(nextArgument());
+            }
+            else if (arg == "--worker-command"){
+                options.coordinator.workerCommand = nextArgument();
+            }
+            else if (arg == "--retries"){
+                options.coordinator.maxRetries = std::stoi(nextArgument());
+            }
+            else if (arg == "--timeout"){
+                options.coordinator.timeout = std::chrono::seconds(std::stoi(nextArgument()));
+            }
+            else if (arg == "--worker"){
+                options.isWorker = true;
+            }
+            else if (arg == "--crash-after"){
+                options.crashAfter = std::stoi(nextArgument());
+            }
+            else if (arg == "--version"){
+                std::cout << "Commit " << Thera::Utils::GitInfo::hash;
+                if (Thera::Utils::GitInfo::isDirty)
+                    std::cout << " + local changes";
+                std::cout << "\n";
+                return 0;
+            }
+            else{
+                options.depth = std::stoi(arg);
+            }
+        }
+        catch(std::exception const& e){
+            std::cout << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    if (options.isWorker){
+        return runWorker(options);
+    }
+
+    if (options.depth < 2){
+        printHelp(argv[0]);
+        return 1;
+    }
+    if (options.coordinator.workerCommand.empty()){
+        options.coordinator.workerCommand = getDefaultWorkerCommand(argv[0]);
+    }
+
+    Thera::Board board;
+    Thera::MoveGenerator generator;
+
+    try{
+        board.loadFromFEN(options.fen);
+
+        const auto start = std::chrono::high_resolution_clock::now();
+
+        const TreeSplit split = splitTree(board, generator, options.depth, std::min(options.splitDepth, options.depth-1));
+        std::cout << "Split into " << split.items.size() << " work items.\n";
+
+        Coordinator coordinator(options.coordinator);
+        const auto itemResults = coordinator.run(split.items);
+
+        std::vector<uint64_t> rootMoveResults(split.rootMoves.size(), 0);
+        for (size_t item=0; item<split.items.size(); item++){
+            for (auto [rootMove, numPaths] : split.occurrences.at(item)){
+                rootMoveResults.at(rootMove) += numPaths * itemResults.at(item);
+            }
+        }
+
+        const auto stop = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> duration = stop-start;
+
+        uint64_t numNodes = 0;
+        for (size_t move=0; move<split.rootMoves.size(); move++){
+            std::cout << split.rootMoves.at(move).toString() << ": " << rootMoveResults.at(move) << "\n";
+            numNodes += rootMoveResults.at(move);
+        }
+
+        const auto& statistics = coordinator.getStatistics();
+        std::cout << "\nNodes searched: " << numNodes << "\n";
+        std::cout << "Retried " << statistics.numRetries << " items, restarted " << statistics.numWorkerRestarts << " and dropped " << statistics.numDroppedWorkers << " workers.\n";
+        std::cout << "Took " << duration.count() << "s (" << uint64_t(numNodes / duration.count()) << " nodes/s)\n";
+    }
+    catch(std::exception const& e){
+        std::cout << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "TheraServer/Session.hpp"
+
+#include "Thera/TranspositionTable.hpp"
+#include "Thera/ThreadPool.hpp"
+
+#include <string>
+#include <map>
+#include <memory>
+#include <atomic>
+
+/**
+ * @brief Accepts analysis sessions on a Unix domain socket and runs their searches on a fixed pool of workers.
+ * 
+ * Every worker runs one single threaded search at a time, further searches wait in the queue of the pool.
+ * All sockets are handled by the thread calling run, so sessions only need their own thread while searching.
+ */
+class AnalysisServer{
+    public:
+        struct Options{
+            std::string socketPath;
+            int numWorkers = 1;
+            int maxSessions = 64;
+            // the size of a table shared by all sessions, 0 gives every session its own table
+            size_t sharedTableSizeMB = 0;
+            size_t sessionTableSizeMB = Thera::TranspositionTable::defaultSizeMB;
+            Session::Limits limits;
+        };
+
+        /**
+         * @brief Start listening. Throws std::runtime_error if the socket can't be created.
+         * 
+         * @param options the options
+         */
+        AnalysisServer(Options const& options);
+        ~AnalysisServer();
+
+        AnalysisServer(AnalysisServer const&) = delete;
+        AnalysisServer& operator = (AnalysisServer const&) = delete;
+
+        /**
+         * @brief Serve clients until shouldStop is set. Running searches are stopped before returning.
+         * 
+         * @param shouldStop checked regularly
+         */
+        void run(std::atomic<bool> const& shouldStop);
+
+    private:
+        void acceptClient();
+
+        Options options;
+        int listenFD = -1;
+
+        // declared before the workers, since their tasks may still use it
+        std::unique_ptr<Thera::TranspositionTable> sharedTable;
+        Thera::ThreadPool workers;
+        std::map<int, std::shared_ptr<Session>> sessions;
+};
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "Thera/Board.hpp"
+#include "Thera/TranspositionTable.hpp"
+#include "Thera/ThreadPool.hpp"
+#include "Thera/search.hpp"
+
+#include <string>
+#include <sstream>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <optional>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief A client connected to the analysis server.
+ * 
+ * A session keeps its position and, unless the server shares one, its own transposition table
+ * between searches. Searches run as tasks of the server's worker pool.
+ * 
+ * Protocol (one line per message, similar to UCI):
+ *     client -> server:
+ *         position startpos|fen [fen] [moves [move]...]
+ *         go [depth [n]] [nodes [n]] [movetime [ms]]
+ *         stop
+ *         newgame
+ *         isready
+ *         quit
+ *     server -> client:
+ *         info depth [n] score cp|mate [n] nodes [n] time [ms]
+ *         bestmove [move]|(none) [ponder [move]]
+ *         readyok
+ *         error [message]
+ * Every accepted "go" is answered by exactly one "bestmove", so a client should wait for it before the next "go".
+ */
+class Session : public std::enable_shared_from_this<Session>{
+    public:
+        /**
+         * @brief Upper bounds for a single search, used if the client doesn't request less.
+         */
+        struct Limits{
+            int depth = 9999;
+            std::optional<uint64_t> nodes;
+            std::optional<std::chrono::milliseconds> time;
+        };
+
+        /**
+         * @param socketFD the connected socket, which is closed by the session
+         * @param sharedTable a table shared by all sessions or nullptr to allocate an own one
+         * @param tableSizeMB the size of the own table in MiB
+         * @param limits the limits of every search
+         */
+        Session(int socketFD, Thera::TranspositionTable* sharedTable, size_t tableSizeMB, Limits const& limits);
+        ~Session();
+
+        Session(Session const&) = delete;
+        Session& operator = (Session const&) = delete;
+
+        /**
+         * @brief Read all available input and handle complete lines. Should only be called once the socket is readable.
+         * 
+         * @param workers the pool running the searches
+         * @return bool false if the client disconnected or quit
+         */
+        bool receive(Thera::ThreadPool& workers);
+
+        /**
+         * @brief Stop the running search, if any. Its result is still sent.
+         */
+        void stop(){ searchShouldStop = true; }
+
+        int getSocketFD() const { return socketFD; }
+
+    private:
+        struct SearchRequest{
+            Thera::Board board;
+            int depth;
+            std::optional<uint64_t> nodes;
+            std::optional<std::chrono::milliseconds> time;
+        };
+
+        /**
+         * @brief Handle a single line.
+         * 
+         * @return bool false if the client quit
+         */
+        bool handleLine(std::string const& line, Thera::ThreadPool& workers);
+        void handlePosition(std::stringstream& lineStream);
+        void handleGo(std::stringstream& lineStream, Thera::ThreadPool& workers);
+
+        /**
+         * @brief Run a search and send its result. Called by the worker pool.
+         */
+        void runSearch(SearchRequest const& request);
+
+        /**
+         * @brief Send a line to the client. Failures are ignored, since a disconnect is noticed while receiving.
+         * 
+         * @param line the line without the trailing newline
+         */
+        void send(std::string const& line);
+
+        static constexpr size_t maxLineLength = 1 << 16;
+
+        int socketFD;
+        std::string buffer;
+        std::mutex sendMutex;
+
+        Thera::Board board;
+        std::unique_ptr<Thera::TranspositionTable> ownTable;
+        Thera::TranspositionTable* transpositionTable;
+        Limits limits;
+
+        std::atomic<bool> isSearching = false;
+        std::atomic<bool> searchShouldStop = false;
+};
@@ -0,0 +1,100 @@
+#include "TheraServer/AnalysisServer.hpp"
+
+#include <vector>
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <filesystem>
+
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+AnalysisServer::AnalysisServer(Options const& options): options(options), workers(options.numWorkers){
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (options.socketPath.empty() || options.socketPath.size() >= sizeof(address.sun_path))
+        throw std::runtime_error("Invalid socket path \"" + options.socketPath + "\"");
+    std::strncpy(address.sun_path, options.socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    // a socket left behind by a server that didn't shut down cleanly would block the address
+    std::error_code error;
+    if (std::filesystem::is_socket(options.socketPath, error))
+        std::filesystem::remove(options.socketPath, error);
+
+    listenFD = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFD == -1)
+        throw std::runtime_error(std::string("Unable to create socket: ") + strerror(errno));
+    if (bind(listenFD, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listenFD, SOMAXCONN) != 0){
+        const std::string message = std::string("Unable to listen on \"") + options.socketPath + "\": " + strerror(errno);
+        close(listenFD);
+        throw std::runtime_error(message);
+    }
+
+    if (options.sharedTableSizeMB > 0){
+        sharedTable = std::make_unique<Thera::TranspositionTable>();
+        sharedTable->resize(options.sharedTableSizeMB, true);
+    }
+}
+
+AnalysisServer::~AnalysisServer(){
+    for (auto& [fd, session] : sessions){
+        session->stop();
+    }
+    workers.wait();
+    sessions.clear();
+
+    close(listenFD);
+    std::error_code error;
+    std::filesystem::remove(options.socketPath, error);
+}
+
+void AnalysisServer::run(std::atomic<bool> const& shouldStop){
+    // wake up regularly to check shouldStop
+    constexpr int pollTimeoutMS = 200;
+
+    while (!shouldStop){
+        std::vector<pollfd> pollFDs;
+        pollFDs.push_back(pollfd{.fd = listenFD, .events = POLLIN, .revents = 0});
+        for (auto const& [fd, session] : sessions){
+            pollFDs.push_back(pollfd{.fd = fd, .events = POLLIN, .revents = 0});
+        }
+
+        const int numReady = poll(pollFDs.data(), pollFDs.size(), pollTimeoutMS);
+        if (numReady < 0 && errno == EINTR) continue;
+        if (numReady < 0) throw std::runtime_error(std::string("Unable to poll sockets: ") + strerror(errno));
+
+        for (size_t i=1; i<pollFDs.size(); i++){
+            if (pollFDs.at(i).revents == 0) continue;
+
+            auto sessionIt = sessions.find(pollFDs.at(i).fd);
+            if (!sessionIt->second->receive(workers)){
+                // a running search keeps the session alive until it has finished
+                sessionIt->second->stop();
+                sessions.erase(sessionIt);
+            }
+        }
+
+        if (pollFDs.front().revents != 0) acceptClient();
+    }
+
+    for (auto& [fd, session] : sessions){
+        session->stop();
+    }
+    workers.wait();
+}
+
+void AnalysisServer::acceptClient(){
+    const int clientFD = accept4(listenFD, nullptr, nullptr, SOCK_CLOEXEC);
+    if (clientFD == -1) return;
+
+    if (sessions.size() >= size_t(options.maxSessions)){
+        const std::string message = "error too many sessions\n";
+        ::send(clientFD, message.data(), message.size(), MSG_NOSIGNAL);
+        close(clientFD);
+        return;
+    }
+
+    sessions.emplace(clientFD, std::make_shared<Session>(clientFD, sharedTable.get(), options.sessionTableSizeMB, options.limits));
+}
@@ -0,0 +1,231 @@
+#include "TheraServer/Session.hpp"
+
+#include "Thera/MoveGenerator.hpp"
+#include "Thera/Move.hpp"
+#include "Thera/Utils/ChessTerms.hpp"
+
+#include <algorithm>
+#include <vector>
+#include <stdexcept>
+#include <cerrno>
+
+#include <unistd.h>
+#include <sys/socket.h>
+
+Session::Session(int socketFD, Thera::TranspositionTable* sharedTable, size_t tableSizeMB, Limits const& limits): socketFD(socketFD), limits(limits){
+    if (sharedTable){
+        transpositionTable = sharedTable;
+    }
+    else{
+        ownTable = std::make_unique<Thera::TranspositionTable>(tableSizeMB);
+        transpositionTable = ownTable.get();
+    }
+    board.loadFromFEN(Thera::Utils::startingFEN);
+}
+
+Session::~Session(){
+    close(socketFD);
+}
+
+bool Session::receive(Thera::ThreadPool& workers){
+    char chunk[4096];
+    ssize_t numRead;
+    do{
+        numRead = read(socketFD, chunk, sizeof(chunk));
+    } while (numRead < 0 && errno == EINTR);
+    if (numRead <= 0) return false;
+
+    buffer.append(chunk, numRead);
+    size_t lineEnd;
+    while ((lineEnd = buffer.find('\n')) != std::string::npos){
+        std::string line = buffer.substr(0, lineEnd);
+        buffer.erase(0, lineEnd+1);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!handleLine(line, workers)) return false;
+    }
+
+    if (buffer.size() > maxLineLength){
+        send("error line too long");
+        return false;
+    }
+    return true;
+}
+
+bool Session::handleLine(std::string const& line, Thera::ThreadPool& workers){
+    std::stringstream lineStream(line);
+    std::string command;
+    if (!(lineStream >> command)) return true;
+
+    try{
+        if (command == "position"){
+            handlePosition(lineStream);
+        }
+        else if (command == "go"){
+            handleGo(lineStream, workers);
+        }
+        else if (command == "stop"){
+            stop();
+        }
+        else if (command == "newgame"){
+            if (isSearching) throw std::invalid_argument("can't start a new game while searching");
+            board.loadFromFEN(Thera::Utils::startingFEN);
+            // a shared table also holds the entries of other sessions
+            if (ownTable) ownTable->clear(1);
+        }
+        else if (command == "isready"){
+            send("readyok");
+        }
+        else if (command == "quit"){
+            stop();
+            return false;
+        }
+        else{
+            throw std::invalid_argument("unknown command '" + command + "'");
+        }
+    }
+    catch(std::exception const& e){
+        send(std::string("error ") + e.what());
+    }
+    return true;
+}
+
+void Session::handlePosition(std::stringstream& lineStream){
+    // only replace the position once the whole command is valid
+    Thera::Board newBoard;
+
+    std::string token;
+    lineStream >> token;
+    if (token == "startpos"){
+        newBoard.loadFromFEN(Thera::Utils::startingFEN);
+        token.clear();
+        lineStream >> token;
+    }
+    else if (token == "fen"){
+        std::string fen;
+        while (lineStream >> token && token != "moves"){
+            fen += token + " ";
+        }
+        if (token != "moves") token.clear();
+        newBoard.loadFromFEN(fen);
+    }
+    else{
+        throw std::invalid_argument("expected 'startpos' or 'fen' after 'position'");
+    }
+
+    if (!token.empty() && token != "moves") throw std::invalid_argument("unexpected '" + token + "' in 'position'");
+
+    Thera::MoveGenerator generator;
+    while (lineStream >> token){
+        const auto possibleMoves = generator.generateAllMoves(newBoard);
+        const Thera::Move inputMove = Thera::Move::fromString(token);
+        auto moveIt = std::find_if(possibleMoves.begin(), possibleMoves.end(), [&](auto const& other){ return Thera::Move::isSameBaseMove(inputMove, other); });
+        if (moveIt == possibleMoves.end()) throw std::invalid_argument("illegal move '" + token + "'");
+        newBoard.applyMove(*moveIt);
+    }
+
+    board = newBoard;
+}
+
+void Session::handleGo(std::stringstream& lineStream, Thera::ThreadPool& workers){
+    if (isSearching) throw std::invalid_argument("a search is already running");
+
+    SearchRequest request{
+        .board = board,
+        .depth = limits.depth,
+        .nodes = limits.nodes,
+        .time = limits.time,
+    };
+
+    // the client may only lower the limits of the server
+    std::string token;
+    while (lineStream >> token){
+        std::string value;
+        if (!(lineStream >> value)) throw std::invalid_argument("missing value for '" + token + "'");
+
+        if (token == "depth"){
+            request.depth = std::min(request.depth, std::stoi(value));
+            if (request.depth < 1) throw std::invalid_argument("the depth has to be at least 1");
+        }
+        else if (token == "nodes"){
+            request.nodes = std::min(request.nodes.value_or(UINT64_MAX), uint64_t(std::stoull(value)));
+        }
+        else if (token == "movetime"){
+            request.time = std::min(request.time.value_or(std::chrono::milliseconds::max()), std::chrono::milliseconds(std::stoll(value)));
+        }
+        else{
+            throw std::invalid_argument("unknown parameter '" + token + "' for 'go'");
+        }
+    }
+
+    isSearching = true;
+    searchShouldStop = false;
+    workers.submit([session = shared_from_this(), request](int){
+        session->runSearch(request);
+    });
+}
+
+void Session::runSearch(SearchRequest const& request){
+    Thera::Board searchBoard = request.board;
+    Thera::MoveGenerator generator;
+
+    const auto start = std::chrono::steady_clock::now();
+    uint64_t totalNodes = 0;
+    uint64_t previousIterationNodes = 0;
+    const auto callback = [&](Thera::SearchResult const& result){
+        totalNodes += result.nodesSearched;
+
+        std::stringstream info;
+        info << "info depth " << result.depthReached << " ";
+        if (result.isMate){
+            int movesLeft = (result.depthReached+3)/2;
+            if (result.maxEval < 0){
+                movesLeft = -movesLeft;
+            }
+            info << "score mate " << movesLeft << " ";
+        }
+        else{
+            info << "score cp " << result.maxEval << " ";
+        }
+        info << "nodes " << totalNodes << " ";
+        info << "time " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        send(info.str());
+
+        // iterations can't be interrupted by the node count, so don't start one that would likely exceed the budget
+        if (request.nodes.has_value()){
+            const double growth = previousIterationNodes ? double(result.nodesSearched) / previousIterationNodes : 1;
+            if (totalNodes + result.nodesSearched * growth > request.nodes.value()) searchShouldStop = true;
+        }
+        previousIterationNodes = result.nodesSearched;
+    };
+
+    std::string bestMoveLine = "bestmove (none)";
+    try{
+        const auto result = Thera::search(searchBoard, generator, *transpositionTable, request.depth, request.time, searchShouldStop, callback);
+        if (!result.moves.empty()){
+            const auto bestMove = Thera::getRandomBestMove(result);
+            bestMoveLine = "bestmove " + bestMove.move.toString();
+            if (bestMove.ponderMove.has_value()){
+                bestMoveLine += " ponder " + bestMove.ponderMove.value().toString();
+            }
+        }
+    }
+    catch(std::exception const& e){
+        send(std::string("error ") + e.what());
+    }
+
+    // cleared first, so a client may start the next search as soon as it reads the result
+    isSearching = false;
+    send(bestMoveLine);
+}
+
+void Session::send(std::string const& line){
+    const std::string data = line + "\n";
+    std::scoped_lock lock(sendMutex);
+    size_t written = 0;
+    while (written < data.size()){
+        const ssize_t result = ::send(socketFD, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+        if (result < 0 && errno == EINTR) continue;
+        if (result <= 0) return;
+        written += result;
+    }
+}
@@ -0,0 +1,113 @@
+#include "TheraServer/AnalysisServer.hpp"
+
+#include "Thera/Utils/GitInfo.hpp"
+
+#include <iostream>
+#include <string>
+#include <stdexcept>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <signal.h>
+
+static std::atomic<bool> shouldStop = false;
+
+static void handleSignal(int){
+    shouldStop = true;
+}
+
+void printHelp(std::string const& argv0){
+    std::cout << "Usage: " << argv0 << " [options] [socket path]\n" <<
+R"(Serves analysis sessions over a Unix domain socket. Every connection is a session with its own position,
+the protocol is described in TheraServer/Session.hpp.
+
+Options:
+    -h/--help               Print this helping text
+    --workers [n]           The number of searches running at the same time (default: number of cores)
+    --max-sessions [n]      The number of concurrently connected clients (default: 64)
+    --shared-hash [MiB]     Share a transposition table of this size between all sessions
+    --session-hash [MiB]    The size of the own transposition table of each session, if none is shared (default: 16)
+    --max-depth [n]         The maximum depth of a single search
+    --max-nodes [n]         The maximum number of nodes of a single search
+    --max-time [ms]         The maximum time of a single search
+    --version               Get the current version (git hash) and exit.
+)";
+}
+
+int main(int argc, const char** argv){
+    AnalysisServer::Options options;
+    options.numWorkers = std::max(1u, std::thread::hardware_concurrency());
+
+    int i = 0;
+    while (i+1 < argc){
+        std::string arg = argv[++i];
+        const auto nextArgument = [&]() -> std::string{
+            if (i+1 >= argc) throw std::invalid_argument("Missing value for \"" + arg + "\" option");
+            return argv[++i];
+        };
+
+        try{
+            if (arg == "-h" || arg == "--help"){
+                printHelp(argv[0]);
+                return 0;
+            }
+            else if (arg == "--workers"){
+                options.numWorkers = std::stoi(nextArgument());
+                if (options.numWorkers < 1) throw std::invalid_argument("At least one worker is needed");
+            }
+            else if (arg == "--max-sessions"){
+                options.maxSessions = std::stoi(nextArgument());
+            }
+            else if (arg == "--shared-hash"){
+                options.sharedTableSizeMB = std::stoull(nextArgument());
+            }
+            else if (arg == "--session-hash"){
+                options.sessionTableSizeMB = std::stoull(nextArgument());
+            }
+            else if (arg == "--max-depth"){
+                options.limits.depth = std::stoi(nextArgument());
+            }
+            else if (arg == "--max-nodes"){
+                options.limits.nodes = std::stoull(nextArgument());
+            }
+            else if (arg == "--max-time"){
+                options.limits.time = std::chrono::milliseconds(std::stoll(nextArgument()));
+            }
+            else if (arg == "--version"){
+                std::cout << "Commit " << Thera::Utils::GitInfo::hash;
+                if (Thera::Utils::GitInfo::isDirty)
+                    std::cout << " + local changes";
+                std::cout << "\n";
+                return 0;
+            }
+            else{
+                options.socketPath = arg;
+            }
+        }
+        catch(std::exception const& e){
+            std::cout << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    if (options.socketPath.empty()){
+        printHelp(argv[0]);
+        return 1;
+    }
+
+    signal(SIGINT, handleSignal);
+    signal(SIGTERM, handleSignal);
+
+    try{
+        AnalysisServer server(options);
+        std::cout << "Listening on " << options.socketPath << " with " << options.numWorkers << " worker(s).\n";
+        server.run(shouldStop);
+    }
+    catch(std::exception const& e){
+        std::cout << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
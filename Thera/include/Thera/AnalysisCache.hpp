@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <optional>
+
+namespace Thera{
+
+struct Move;
+
+/**
+ * @brief A persistent cache of finished searches keyed by zobrist hash.
+ * 
+ * Results are appended to a log file ("<path>.log") that is never rewritten.
+ * A memory mapped open addressing hash index ("<path>.idx") points to the newest, deepest
+ * record for every key. The index is rebuilt from the log if it is missing or out of date.
+ * Only one process may use a cache at a time.
+ */
+class AnalysisCache{
+    public:
+        struct Entry{
+            enum class Flag : uint8_t{
+                Exact,
+                LowerBound,
+                UpperBound,
+            };
+
+            uint64_t key = 0;
+            int32_t eval = 0;
+            int16_t depth = 0;
+            uint16_t move = 0;
+            Flag flag = Flag::Exact;
+        };
+
+        AnalysisCache() = default;
+        AnalysisCache(AnalysisCache const&) = delete;
+        AnalysisCache& operator = (AnalysisCache const&) = delete;
+        ~AnalysisCache();
+
+        /**
+         * @brief Open or create a cache.
+         * 
+         * @param path the path of the cache without file extension
+         */
+        void open(std::string const& path);
+        void close();
+
+        constexpr bool isOpen() const { return logFile != -1; }
+
+        /**
+         * @brief Get the deepest entry stored for a key.
+         * 
+         * @param key the zobrist hash
+         * @return std::optional<Entry> the entry if there is one
+         */
+        std::optional<Entry> read(uint64_t key) const;
+
+        /**
+         * @brief Append an entry to the log. The index is only updated if it is at least as deep as the current one.
+         * 
+         * @param entry the entry to store
+         */
+        void write(Entry const& entry);
+
+    private:
+        struct IndexHeader;
+        struct IndexSlot;
+
+        /**
+         * @brief Map the index if it is valid and up to date with the log, otherwise rebuild it.
+         */
+        void loadIndex();
+        void mapIndex(uint64_t capacity);
+        void unmapIndex();
+        void rebuildIndex(uint64_t capacity);
+        void indexLogRange(uint64_t begin, uint64_t end);
+        void insertIntoIndex(Entry const& entry, uint64_t logOffset);
+        Entry readLogRecord(uint64_t logOffset) const;
+
+        std::string indexPath;
+        int logFile = -1;
+        int indexFile = -1;
+        IndexHeader* header = nullptr;
+        IndexSlot* slots = nullptr;
+        size_t mappedSize = 0;
+};
+
+}
@@ -4,7 +4,7 @@
 
 #include "Thera/Utils/BuildType.hpp"
 #include "Thera/Utils/Math.hpp"
-#include "Thera/Coordinate.hpp"
+#include "Thera/Square.hpp"
 
 #include <array>
 #include <cstdint>
@@ -38,7 +38,7 @@ class Bitboard{
          * @return true 
          * @return false 
          */
-        constexpr bool isOccupied(Coordinate square) const{
+        constexpr bool isOccupied(Square square) const{
             if constexpr (Utils::BuildType::Current == Utils::BuildType::Debug)
                 if (!Utils::isInRange<uint8_t>(square.getIndex64(), 0, 63))
                     throw std::out_of_range("Square index is outside the board");
@@ -66,7 +66,7 @@ class Bitboard{
          * 
          * @param square
          */
-        constexpr void placePiece(Coordinate square){
+        constexpr void placePiece(Square square){
             if constexpr (Utils::BuildType::Current == Utils::BuildType::Debug){
                 if (isOccupied(square))
                     throw std::invalid_argument("Tried to place piece on already occupied square.");
@@ -82,7 +82,7 @@ class Bitboard{
          * 
          * @param square 
          */
-        constexpr void removePiece(Coordinate square){
+        constexpr void removePiece(Square square){
             clearBit(square.getIndex64());
         }
 
@@ -102,13 +102,13 @@ class Bitboard{
             return std::popcount(bits);
         }
 
-        constexpr bool operator[] (Coordinate bitIdx) const{
+        constexpr bool operator[] (Square bitIdx) const{
             return Utils::getBit(bits, bitIdx.getIndex64());
         }
         constexpr bool operator[] (uint8_t bitIdx) const{
             return Utils::getBit(bits, bitIdx);
         }
-        constexpr bool operator[] (Coordinate bitIdx){
+        constexpr bool operator[] (Square bitIdx){
             return Utils::getBit(bits, bitIdx.getIndex64());
         }
         constexpr bool operator[] (uint8_t bitIdx){
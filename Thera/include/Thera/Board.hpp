@@ -2,7 +2,7 @@
 
 #include "Thera/Piece.hpp"
 #include "Thera/Bitboard.hpp"
-#include "Thera/Coordinate.hpp"
+#include "Thera/Square.hpp"
 
 #include <array>
 #include <cstdint>
@@ -10,10 +10,32 @@
 #include <stack>
 #include <optional>
 #include <unordered_map>
+#include <vector>
 
 namespace Thera{
 struct Move;
 
+/**
+ * @brief How Board::applyMove and Board::rewindMove keep the previous states.
+ * 
+ */
+enum class MoveApplication{
+	/// push a copy of the state onto the rewind stack and modify the state in place, rewinding copies it back
+	MakeUnmake,
+	/// copy the state into the slot of the next ply and modify that copy, rewinding only steps back one ply
+	CopyMake,
+};
+
+/**
+ * @brief The move application used by the search and perft, selected with the THERA_COPY_MAKE build option.
+ * 
+ */
+#ifdef THERA_COPY_MAKE
+inline constexpr MoveApplication searchMoveApplication = MoveApplication::CopyMake;
+#else
+inline constexpr MoveApplication searchMoveApplication = MoveApplication::MakeUnmake;
+#endif
+
 /**
  * @brief A chess board representation.
  * 
@@ -28,7 +50,7 @@ class Board{
 		 * @param index index
 		 * @return Piece piece
 		 */
-		Piece at(Coordinate index) const;
+		Piece at(Square index) const;
 
 		/**
 		 * @brief Load a board position from a FEN string.
@@ -51,8 +73,12 @@ class Board{
 		/**
 		 * @brief Make a move on the board and update the state.
 		 * 
+		 * Moves have to be rewound with the same move application they were made with.
+		 * 
+		 * @tparam application how the previous state is kept
 		 * @param move
 		 */
+		template<MoveApplication application = MoveApplication::MakeUnmake>
 		void applyMove(Move const& move);
 
 		/**
@@ -65,7 +91,9 @@ class Board{
 		/**
 		 * @brief Rewind the last applied move.
 		 * 
+		 * @tparam application the move application the move was made with
 		 */
+		template<MoveApplication application = MoveApplication::MakeUnmake>
 		void rewindMove();
 
 		/**
@@ -73,80 +101,70 @@ class Board{
 		 * 
 		 * @return PieceColor 
 		 */
-		constexpr PieceColor getColorToMove() const { return currentState.isWhiteToMove ? PieceColor::White : PieceColor::Black; }
+		constexpr PieceColor getColorToMove() const { return state().isWhiteToMove ? PieceColor::White : PieceColor::Black; }
 
 		/**
 		 * @brief Get the color that has just made a move.
 		 * 
 		 * @return PieceColor 
 		 */
-		constexpr PieceColor getColorToNotMove() const { return currentState.isWhiteToMove ? PieceColor::Black : PieceColor::White; }
+		constexpr PieceColor getColorToNotMove() const { return state().isWhiteToMove ? PieceColor::Black : PieceColor::White; }
 
 		/**
 		 * @brief Get the current state.
 		 * 
 		 * @return BoardState the current board state
 		 */
-		constexpr BoardState const& getCurrentState() const { return currentState; }
+		constexpr BoardState const& getCurrentState() const { return state(); }
 
 		/**
 		 * @brief Get the en passant square.
 		 * 
-		 * @return Coordinate 
+		 * @return Square 
 		 */
-		constexpr Coordinate getEnPassantSquareForFEN() const { return currentState.enPassantSquareForFEN; }
+		constexpr Square getEnPassantSquareForFEN() const { return state().enPassantSquare; }
 
 		/**
 		 * @brief Get the en passant square to capture.
 		 * 
-		 * @return Coordinate 
+		 * @return Square 
 		 */
-		constexpr Coordinate getEnPassantSquareToCapture() const { return currentState.enPassantSquareToCapture; }
+		constexpr Square getEnPassantSquareToCapture() const {
+			// the pawn that jumped over the third rank stands on the fourth one, the one that jumped over the sixth rank on the fifth one
+			return state().enPassantSquare + (state().enPassantSquare.getRank() == 2 ? DirectionIndex64::N : DirectionIndex64::S);
+		}
 
 		/**
 		 * @brief Is en passant possible.
 		*/
-		constexpr bool hasEnPassant() const{ return currentState.hasEnPassant; }
+		constexpr bool hasEnPassant() const{ return state().hasEnPassant(); }
 
 		/**
 		 * @brief Get the bitboard containing a particular piece. 
 		 * 
-		 * @param piece the piece
-		 * @return Bitboard& the bitboard containing these pieces
-		 */
-		constexpr Bitboard& getBitboard(Piece piece){ return currentState.pieceBitboards.at(piece.getRaw()); }
-		
-		/**
-		 * @brief Get the bitboard to place a particular piece. 
-		 * 
-		 * @param piece the piece
+		 * @param piece the piece, its type must not be None
 		 * @return Bitboard the bitboard containing these pieces
 		 */
-		constexpr Bitboard getBitboard(Piece piece) const{ return currentState.pieceBitboards.at(piece.getRaw()); }
+		constexpr Bitboard getBitboard(Piece piece) const{
+			return state().pieceTypeBitboards[static_cast<int>(piece.type) - 1] & state().colorBitboards[static_cast<int>(piece.color)];
+		}
 
 		/**
-		 * @brief Get the bitboard containing all pieces 
+		 * @brief Get the bitboard containing all pieces of one type, regardless of their color.
 		 * 
-		 * @return Bitboard& the bitboard containing all pieces
+		 * @param type the piece type, must not be None
+		 * @return Bitboard the bitboard containing these pieces
 		 */
-		constexpr Bitboard& getAllPieceBitboard(){ return currentState.allPieceBitboard; }
+		constexpr Bitboard getPieceTypeBitboard(PieceType type) const{
+			return state().pieceTypeBitboards[static_cast<int>(type) - 1];
+		}
 
 		/**
 		 * @brief Get the bitboard containing all pieces 
 		 * 
 		 * @return Bitboard the bitboard containing all pieces
 		 */
-		constexpr Bitboard getAllPieceBitboard() const{ return currentState.allPieceBitboard; }
-
-		/**
-		 * @brief Get the bitboard containing all pieces of one color
-		 * 
-		 * @param color whose pieces to return
-		 * @return Bitboard& the bitboard containing all pieces one color
-		 */
-		constexpr Bitboard& getPieceBitboardForOneColor(PieceColor color){
-			return currentState.pieceBitboards.at(Piece(PieceType::None, color).getRaw());
-		}
+		constexpr Bitboard getAllPieceBitboard() const{ return state().colorBitboards[0] | state().colorBitboards[1]; }
 
 		/**
 		 * @brief Get the bitboard containing all pieces of one color
@@ -155,7 +173,7 @@ class Board{
 		 * @return Bitboard the bitboard containing all pieces one color
 		 */
 		constexpr Bitboard getPieceBitboardForOneColor(PieceColor color) const {
-			return currentState.pieceBitboards.at(Piece(PieceType::None, color).getRaw());
+			return state().colorBitboards[static_cast<int>(color)];
 		}
 
 		/**
@@ -164,21 +182,22 @@ class Board{
 		 * @param square the square 
 		 * @param piece the piece to place
 		 */
-		void placePiece(Coordinate square, Piece piece);
+		void placePiece(Square square, Piece piece);
 
 		/**
 		 * @brief Remove a piece from the board.
 		 * 
 		 * @param square the square
 		 */
-		void removePiece(Coordinate square);
+		void removePiece(Square square);
 
 		/**
-		 * @brief Remove castlings.
+		 * @brief Remove a piece of known type from the board. Only touches the affected bitboards.
 		 * 
-		 * @param movedSquare the square whose piece got moved
+		 * @param square the square
+		 * @param piece the piece on the square
 		 */
-		void removeCastlings(Coordinate movedSquare);
+		void removePiece(Square square, Piece piece);
 
 		/**
 		 * @brief Change the color to move.
@@ -187,8 +206,8 @@ class Board{
 		 * 
 		 */
 		constexpr void switchPerspective(){
-			currentState.isWhiteToMove = !currentState.isWhiteToMove;
-			currentState.zobristHash ^= zobristBlackToMove;
+			state().isWhiteToMove = !state().isWhiteToMove;
+			state().zobristHash ^= zobristBlackToMove;
 		}
 
 		/**
@@ -196,7 +215,7 @@ class Board{
 		 * 
 		 * @return constexpr uint64_t 
 		 */
-		constexpr uint64_t getCurrentHash() const { return currentState.zobristHash; }
+		constexpr uint64_t getCurrentHash() const { return state().zobristHash; }
 
 		/**
 		 * @brief Compares the hashes of the boards. DO NOT USE OUTSIDE OF HASHMAP!
@@ -216,34 +235,190 @@ class Board{
 			return numberOfPositionRepetitions.contains(hash) && numberOfPositionRepetitions.at(hash) >= 3;
 		}
 
+		/**
+		 * @brief Enable or disable the experimental incrementally updated attack tables.
+		 * 
+		 * While enabled, every move updates the attacks of the pieces on the changed squares and of all sliders whose rays pass through them.
+		 * Rewinding restores the tables from a history stack.
+		 * placePiece and removePiece don't update the tables, call refreshAttackTables after using them.
+		 * 
+		 * @param enabled whether to track attacks
+		 */
+		void setAttackTracking(bool enabled);
+
+		constexpr bool isTrackingAttacks() const { return attackTracking; }
+
+		/**
+		 * @brief Recompute the attack tables from scratch.
+		 * 
+		 */
+		void refreshAttackTables();
+
+		/**
+		 * @brief Get the squares attacked by the piece on a square. Only valid while tracking attacks.
+		 * 
+		 * @param square the square of the attacking piece
+		 * @return Bitboard the attacked squares, empty if there is no piece
+		 */
+		constexpr Bitboard getAttacksFrom(Square square) const { return attackTables.attacksFrom[square.getIndex64()]; }
+
+		/**
+		 * @brief Get the pieces of both colors attacking a square. Only valid while tracking attacks.
+		 * 
+		 * @param square the attacked square
+		 * @return Bitboard the squares of the attacking pieces
+		 */
+		constexpr Bitboard getAttacksTo(Square square) const { return attackTables.attacksTo[square.getIndex64()]; }
+
+		/**
+		 * @brief Get all squares attacked by one color. Only valid while tracking attacks.
+		 * 
+		 * @param color the attacking color
+		 * @return Bitboard the attacked squares
+		 */
+		Bitboard getAttackedSquares(PieceColor color) const;
+
 	public:
 		struct BoardState{
 			/**
-			 * @brief Bitboards for all pieces. None and some color represent all pieces of said color.
+			 * @brief Bitboards of the pieces of both colors for every piece type, indexed by the type minus one.
+			 * 
+			 */
+			std::array<Bitboard, 6> pieceTypeBitboards;
+
+			/**
+			 * @brief Bitboards of all pieces of one color, indexed by the color.
 			 * 
 			 */
-			std::array<Bitboard, 16> pieceBitboards;
-			Bitboard allPieceBitboard;
-
-			bool hasEnPassant = false;
-			Coordinate enPassantSquareForFEN;
-			Coordinate enPassantSquareToCapture;
-
-			bool isWhiteToMove: 1;
-			bool canWhiteCastleLeft: 1;
-			bool canBlackCastleLeft: 1;
-			bool canWhiteCastleRight: 1;
-			bool canBlackCastleRight: 1;
-			uint64_t zobristHash;
+			std::array<Bitboard, 2> colorBitboards;
+
+			uint64_t zobristHash = 0;
+
+			/**
+			 * @brief The square jumped over by a double pawn move in the last ply.
+			 * 
+			 * a1 can never be an en passant square, so it marks that en passant isn't possible.
+			 * 
+			 */
+			Square enPassantSquare;
+
+			enum CastlingRight : uint8_t{
+				WhiteLeft = 1 << 0,
+				WhiteRight = 1 << 1,
+				BlackLeft = 1 << 2,
+				BlackRight = 1 << 3,
+			};
+
+			uint8_t castlingRights = 0;
+			bool isWhiteToMove = true;
+
+			constexpr bool hasEnPassant() const { return enPassantSquare.getIndex64() != 0; }
+
+			constexpr bool canWhiteCastleLeft() const { return castlingRights & WhiteLeft; }
+			constexpr bool canWhiteCastleRight() const { return castlingRights & WhiteRight; }
+			constexpr bool canBlackCastleLeft() const { return castlingRights & BlackLeft; }
+			constexpr bool canBlackCastleRight() const { return castlingRights & BlackRight; }
 		};
 
 	private:
-		BoardState currentState;
+		/**
+		 * @brief The states of all plies for copy-make, indexed by the number of moves made with copy-make.
+		 * 
+		 * The current state is accessed through a pointer, so it isn't looked up on every access.
+		 * 
+		 */
+		class PlyStates{
+			public:
+				PlyStates(): states(1), current(states.data()){}
+				PlyStates(PlyStates const& other): states(other.states.begin(), other.states.begin() + other.getPly() + 1), current(states.data() + other.getPly()){}
+				PlyStates& operator=(PlyStates const& other){
+					states.assign(other.states.begin(), other.states.begin() + other.getPly() + 1);
+					current = states.data() + other.getPly();
+					return *this;
+				}
+
+				constexpr BoardState& get(){ return *current; }
+				constexpr BoardState const& get() const{ return *current; }
+				size_t getPly() const{ return current - states.data(); }
+
+				/**
+				 * @brief Copy the current state into the next ply and make it the current one.
+				 * 
+				 */
+				void push(){
+					const size_t ply = getPly();
+					if (ply + 1 == states.size()){
+						states.resize(states.size() * 2);
+						current = states.data() + ply;
+					}
+					current[1] = current[0];
+					current++;
+				}
+
+				void pop(){ current--; }
+
+				/**
+				 * @brief Make the current state the one of the first ply.
+				 * 
+				 */
+				void reset(){
+					states.front() = *current;
+					current = states.data();
+				}
+
+			private:
+				std::vector<BoardState> states;
+				BoardState* current;
+		};
+
+		constexpr BoardState& state(){ return plyStates.get(); }
+		constexpr BoardState const& state() const{ return plyStates.get(); }
+
+		/**
+		 * @brief Add or remove a piece on the piece type and color bitboards.
+		 * 
+		 * @param square the square
+		 * @param piece the piece
+		 */
+		constexpr void togglePiece(Square square, Piece piece){
+			const Bitboard bit = Bitboard::fromIndex64(square.getIndex64());
+			state().pieceTypeBitboards[static_cast<int>(piece.type) - 1] ^= bit;
+			state().colorBitboards[static_cast<int>(piece.color)] ^= bit;
+			state().zobristHash ^= zobristTable[square.getIndex64()][piece.getRaw()];
+		}
+
+		struct AttackTables{
+			std::array<Bitboard, 64> attacksFrom;
+			std::array<Bitboard, 64> attacksTo;
+		};
+
+		/**
+		 * @brief Recompute the attacks of the piece on a square and update the reverse table.
+		 * 
+		 * @param square the square of the piece
+		 */
+		void updateAttacksFrom(uint8_t square);
+
+		/**
+		 * @brief Update the attack tables after the pieces on some squares changed.
+		 * 
+		 * @param changedSquares the squares whose contents changed
+		 */
+		void updateAttackTables(Bitboard changedSquares);
+
+		PlyStates plyStates;
 		std::stack<BoardState> rewindStack;
 
+		bool attackTracking = false;
+		AttackTables attackTables;
+		std::stack<AttackTables> attackTablesRewindStack;
+
 		std::array<std::array<uint64_t, 16>, 64> zobristTable;
 		uint64_t zobristBlackToMove;
 		
 		std::unordered_map<uint64_t, int> numberOfPositionRepetitions;
 };
-}
\ No newline at end of file
+
+// rewinding and copy-make copy the whole state on every move
+static_assert(sizeof(Board::BoardState) <= 128, "The board state should fit into two cache lines");
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "Thera/TranspositionTable.hpp"
+#include "Thera/Utils/BoundedQueue.hpp"
+
+#include <cstdint>
+#include <string>
+#include <optional>
+#include <vector>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+
+namespace Thera{
+
+/**
+ * @brief Lets multiple engine processes on one host cooperate by exchanging search results.
+ * 
+ * Every process binds a unix datagram socket named "<pid>.sock" inside a shared directory and
+ * finds its peers by listing that directory. A background thread periodically sends the deep
+ * transposition table entries of the own search to all peers and stores the received ones in the
+ * local table. Completed root iterations are exchanged as well, so the deepest result for a position
+ * can be used by every process. Messages are hints only and may be dropped if a peer is busy.
+ */
+class ClusterNode{
+    public:
+        struct RootResult{
+            uint64_t key = 0;
+            int32_t depth = 0;
+            int32_t eval = 0;
+            // encoded using Move::encode
+            uint16_t move = 0;
+        };
+
+        static constexpr int defaultMinSharedDepth = 4;
+        static constexpr std::chrono::milliseconds exchangeInterval{20};
+        /// entries stored faster than they can be sent are dropped
+        static constexpr size_t maxOutgoingEntries = 1 << 14;
+
+        /**
+         * @param transpositionTable the table whose entries are shared. Has to outlive the node.
+         */
+        ClusterNode(TranspositionTable& transpositionTable);
+        ClusterNode(ClusterNode const&) = delete;
+        ClusterNode& operator = (ClusterNode const&) = delete;
+        ~ClusterNode();
+
+        /**
+         * @brief Join a cluster. The transposition table may not be resized while the node is open.
+         * 
+         * @param directory the directory shared by all processes of the cluster
+         * @param minSharedDepth the minimum depth of shared transposition table entries
+         */
+        void open(std::string const& directory, int minSharedDepth=defaultMinSharedDepth);
+        void close();
+
+        bool isOpen() const { return socketFD != -1; }
+
+        /**
+         * @brief Send the result of a completed root iteration to all peers.
+         * 
+         * @param result the result
+         */
+        void publishRootResult(RootResult const& result);
+
+        /**
+         * @brief Get the deepest root result any process (including this one) published for a position.
+         * 
+         * @param key the zobrist hash of the root position
+         * @return std::optional<RootResult> the result if there is one
+         */
+        std::optional<RootResult> getDeepestRootResult(uint64_t key);
+
+        uint64_t getNumReceivedEntries() const { return numReceivedEntries; }
+
+    private:
+        struct SharedEntry{
+            uint64_t key;
+            TranspositionTable::Entry::Data data;
+        };
+
+        void communicationThreadFunction();
+        void sendToPeers(std::vector<char> const& message);
+        void receiveMessages();
+        void addRootResult(RootResult const& result);
+
+        TranspositionTable& transpositionTable;
+
+        std::string directory;
+        std::string socketPath;
+        int socketFD = -1;
+
+        std::thread communicationThread;
+        std::atomic<bool> communicationThreadShouldExit = false;
+
+        // filled by the searching threads, so they never block on a lock
+        Utils::BoundedQueue<SharedEntry> outgoingEntries{maxOutgoingEntries};
+
+        std::mutex outgoingMutex;
+        std::vector<RootResult> outgoingRootResults;
+
+        std::mutex rootResultsMutex;
+        std::unordered_map<uint64_t, RootResult> rootResults;
+
+        std::atomic<uint64_t> numReceivedEntries = 0;
+};
+
+}
@@ -142,21 +142,4 @@ namespace SquareIndex64 {
     };
 };
 
-namespace Square{
-    #define defSq(NAME) constexpr Coordinate NAME = Coordinate(SquareIndex64::NAME);
-    #define defRow(NAME) defSq(NAME##1) defSq(NAME##2) defSq(NAME##3) defSq(NAME##4) defSq(NAME##5) defSq(NAME##6) defSq(NAME##7) defSq(NAME##8)
-
-    defRow(a);
-    defRow(b);
-    defRow(c);
-    defRow(d);
-    defRow(e);
-    defRow(f);
-    defRow(g);
-    defRow(h);
-
-    #undef defSq
-    #undef defRow
-}
-
 }
\ No newline at end of file
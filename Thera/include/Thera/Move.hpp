@@ -4,19 +4,22 @@
 #include <string>
 
 #include "Thera/Piece.hpp"
-#include "Thera/Coordinate.hpp"
+#include "Thera/Square.hpp"
 
 #include "Thera/Utils/BuildType.hpp"
 
 namespace Thera{
 
+class Board;
+class MoveGenerator;
+
 struct Move{
-    constexpr Move(Coordinate start, Coordinate end): startIndex(start), endIndex(end){
+    constexpr Move(Square start, Square end): startIndex(start), endIndex(end){
     }
-    constexpr Move(Coordinate start, Coordinate end, Piece piece): startIndex(start), endIndex(end), piece(piece){
+    constexpr Move(Square start, Square end, Piece piece): startIndex(start), endIndex(end), piece(piece){
     }
     constexpr Move(){}
-    Coordinate startIndex, endIndex;
+    Square startIndex, endIndex;
     Piece piece;
 
     PieceType promotionType = PieceType::None;
@@ -24,7 +27,7 @@ struct Move{
     bool isEnPassant = false;
 
     bool isCastling = false;
-    Coordinate castlingStart, castlingEnd;
+    Square castlingStart, castlingEnd;
     bool isDoublePawnMove = false;
 
     /**
@@ -47,6 +50,56 @@ struct Move{
      */
     std::string toString() const;
 
+    /**
+     * @brief Parse a string in standard algebraic notation (SAN) as a move.
+     * 
+     * The move is resolved and checked for legality using attack queries only, without generating all moves.
+     * Throws std::invalid_argument if the string isn't a legal move.
+     * Trailing check, mate and annotation symbols are ignored.
+     * Examples:
+     *  "e4"
+     *  "Nbd7"
+     *  "exd8=Q+"
+     *  "O-O-O"
+     * 
+     * @param str the string to parse from
+     * @param board the position the move is played in
+     * @return Move the parsed move with all flags set
+     */
+    static Move fromSAN(std::string const& str, Board const& board);
+
+    /**
+     * @brief Convert the move to standard algebraic notation (SAN).
+     * 
+     * The move has to be legal in the given position and have all flags set (like moves from MoveGenerator).
+     * 
+     * @param board the position the move is played in
+     * @param generator the move generator
+     * @return std::string the move in standard algebraic notation
+     */
+    std::string toSAN(Board& board, MoveGenerator& generator) const;
+
+    /**
+     * @brief Encode the base move (start, end and promotion) into 16 bits.
+     * 
+     * Bits 0-5 hold the end square, bits 6-11 the start square and bits 12-14 the promotion
+     * (1 knight to 4 queen). Castling is encoded as the king capturing its rook.
+     * This is the move format of opening books, analysis caches, search tree dumps and cluster messages.
+     * 
+     * @return uint16_t the encoded move
+     */
+    uint16_t encode() const;
+
+    /**
+     * @brief Decode a move encoded by encode. Only the base move (start, end and promotion) is restored.
+     * 
+     * Castling moves will still be encoded as the king capturing its rook.
+     * 
+     * @param encoded the encoded move
+     * @return Move the decoded move
+     */
+    static Move decode(uint16_t encoded);
+
     constexpr bool operator ==(Move const& other) const{
         bool eq = Move::isSameBaseMove(*this, other);
         if (this->isCastling && other.isCastling)
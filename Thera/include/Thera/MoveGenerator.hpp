@@ -1,7 +1,7 @@
 #pragma once
 
 #include "Thera/Move.hpp"
-#include "Thera/Coordinate.hpp"
+#include "Thera/Square.hpp"
 #include "Thera/Bitboard.hpp"
 
 #include <vector>
@@ -11,6 +11,21 @@
 namespace Thera{
 struct Board;
 
+/**
+ * @brief Attack and threat information about a position.
+ * 
+ * Computed once per search node and shared by move ordering, extensions and pruning.
+ * 
+ */
+struct PositionInfo{
+    /// the pieces giving check to the side to move
+    Bitboard checkers;
+    /// the squares attacked by the other side, sliding attacks go through the king of the side to move
+    Bitboard attackedByThem;
+
+    constexpr bool isInCheck() const{ return checkers.hasPieces(); }
+};
+
 class MoveGenerator{
     public:
         /**
@@ -22,24 +37,90 @@ class MoveGenerator{
         std::vector<Move> generateAllMoves(Board const& board);
 
         /**
-         * @brief Generate all attacked squares.
+         * @brief Generate all attacked squares, pins and check data.
+         * 
+         * The attacked squares are computed set-wise for each piece type.
+         * Per-square attack maps are only generated by generateAttackMaps.
          * 
          * @param board the position to operate on
          */
         void generateAttackData(Board const& board);
 
+        /**
+         * @brief Generate the per-square attack maps of the pieces that aren't moving.
+         * 
+         * They are only needed for debugging, so generateAttackData doesn't compute them.
+         * 
+         * @param board the position to operate on
+         */
+        void generateAttackMaps(Board const& board);
+
+
+        /**
+         * @brief Collect the check and attack information of the position the attack data was generated for.
+         * 
+         * Only data that is already known from move generation is returned, since this is called at every node.
+         * 
+         * @return PositionInfo the information about the position
+         */
+        PositionInfo getPositionInfo() const;
 
         constexpr Bitboard getAttackedSquares() const { return attackedSquares; }
         constexpr Bitboard getPinnedPieces() const{ return pinnedPieces; }
-        constexpr Bitboard getSquaresAttackedBy(Coordinate square) const{
+        constexpr Bitboard getCheckers() const{ return checkers; }
+        /// only valid after generateAttackMaps
+        constexpr Bitboard getSquaresAttackedBy(Square square) const{
             return squaresAttackedBySquare.at(square.getIndex64());
         }
-        constexpr Bitboard getSquaresAttacking(Coordinate square) const{
+        /// only valid after generateAttackMaps
+        constexpr Bitboard getSquaresAttacking(Square square) const{
             return squaresAttackingSquare.at(square.getIndex64());
         }
         constexpr Bitboard getPossibleMoveTargets() const{ return possibleTargets; }
 
         bool isInCheck(Board const& board) const;
+
+        /**
+         * @brief Get the squares a piece would attack from a given square.
+         * 
+         * Pawns aren't supported, since their attacks depend on the color.
+         * 
+         * @param type the type of the attacking piece
+         * @param square the square the piece stands on
+         * @param occupied all pieces that block sliding pieces
+         * @return Bitboard the attacked squares
+         */
+        static Bitboard getPieceAttacks(PieceType type, Square square, Bitboard occupied);
+
+        /**
+         * @brief Get all squares attacked by the pieces of one color.
+         * 
+         * @param board the position to operate on
+         * @param color the attacking color
+         * @param occupied all pieces that block sliding pieces
+         * @return Bitboard the attacked squares
+         */
+        static Bitboard getAttacks(Board const& board, PieceColor color, Bitboard occupied);
+
+        /**
+         * @brief Get the pieces giving check to the side to move without generating any other attack data.
+         * 
+         * @param board the position to operate on
+         * @return Bitboard the checking pieces
+         */
+        static Bitboard getCheckers(Board const& board);
+
+        /**
+         * @brief Get the pieces of both colors attacking a square.
+         * 
+         * Pieces missing from occupied neither attack nor block, so sliders behind removed pieces are found as well.
+         * 
+         * @param board the position to operate on
+         * @param square the attacked square
+         * @param occupied all pieces that may attack or block sliding pieces
+         * @return Bitboard the attacking pieces
+         */
+        static Bitboard getAttackersTo(Board const& board, Square square, Bitboard occupied);
     private:
         
 
@@ -70,7 +151,7 @@ class MoveGenerator{
          * @param square the square to generate moves for
          * @param targetMask a mask to restrict move targets
          */
-        void generateKnightMoves(Board const& board, Coordinate square, Bitboard targetMask);
+        void generateKnightMoves(Board const& board, Square square, Bitboard targetMask);
 
         /**
          * @brief Generate all knight moves.
@@ -89,7 +170,7 @@ class MoveGenerator{
          * @param square the square to generate moves for
          * @param targetMask a mask to restrict move targets
          */
-        void generateKingMoves(Board const& board, Coordinate square, Bitboard targetMask);
+        void generateKingMoves(Board const& board, Square square, Bitboard targetMask);
 
         /**
          * @brief Generate all king moves.
@@ -232,11 +313,45 @@ class MoveGenerator{
             return result;
         }();
 
-        struct DirectionPair{
-            uint8_t dir1: 3;
-            uint8_t dir2: 3;
+        static constexpr auto slidingRaysGenerator = [](bool diagonal) constexpr {
+            std::array<Bitboard, 64> result = {};
+
+            for (int a=0; a<64; a++){
+                for (int b=0; b<64; b++){
+                    const int deltaFile = a % 8 - b % 8, deltaRank = a / 8 - b / 8;
+                    const bool isOnRay = diagonal
+                        ? deltaFile == deltaRank || deltaFile == -deltaRank
+                        : deltaFile == 0 || deltaRank == 0;
+                    if (a != b && isOnRay)
+                        result.at(a).setBit(b);
+                }
+            }
+            return result;
         };
 
+        static constexpr auto rookRaysLUT = slidingRaysGenerator(false);
+        static constexpr auto bishopRaysLUT = slidingRaysGenerator(true);
+
+        /*
+        contents:
+        - the whole line (edge to edge) through two squares, if they share a rank, file or diagonal
+        */
+        static constexpr auto lineLUT = []() constexpr {
+            std::array<std::array<Bitboard, 64>, 64> result = {};
+
+            for (int a=0; a<64; a++){
+                for (int b=0; b<64; b++){
+                    const Bitboard bothSquares = Bitboard::fromIndex64(a) | Bitboard::fromIndex64(b);
+                    // the rays of two squares on a common line only intersect on that line
+                    if (rookRaysLUT.at(a).isOccupied(b))
+                        result.at(a).at(b) = (rookRaysLUT.at(a) & rookRaysLUT.at(b)) | bothSquares;
+                    else if (bishopRaysLUT.at(a).isOccupied(b))
+                        result.at(a).at(b) = (bishopRaysLUT.at(a) & bishopRaysLUT.at(b)) | bothSquares;
+                }
+            }
+            return result;
+        }();
+
         bool capturesOnly = false;
 
     private:
@@ -245,8 +360,11 @@ class MoveGenerator{
         std::array<Bitboard, 64> squaresAttackedBySquare;
         Bitboard attackedSquares;
         Bitboard pinnedPieces;
+        Bitboard sliderCheckers;
+        Bitboard checkers;
         Bitboard possibleTargets;
-        std::array<DirectionPair, 64> pinDirection;
+        /// the line through the king and the pinner, only valid for pinned pieces
+        std::array<Bitboard, 64> pinLines;
         bool isDoubleCheck;
 };
 }
\ No newline at end of file
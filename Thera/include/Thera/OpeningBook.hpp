@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Thera/Move.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <istream>
+#include <ostream>
+
+namespace Thera{
+
+class Board;
+class MoveGenerator;
+
+/**
+ * @brief An opening book in Thera's own file format.
+ * 
+ * Entries are 16 bytes (big-endian key, move, weight and learn value) sorted by key.
+ * The key is the zobrist hash of the board (Board::getCurrentHash()) and the move is
+ * encoded by Move::encode, so books are only compatible between Thera builds.
+ */
+class OpeningBook{
+    public:
+        struct Entry{
+            uint64_t key = 0;
+            uint16_t move = 0;
+            uint16_t weight = 0;
+            uint32_t learn = 0;
+
+            /**
+             * @brief Compare entries by key. Only used for sorting and searching.
+             * 
+             * @param other the other entry
+             * @return bool
+             */
+            bool operator < (Entry const& other) const{
+                return key < other.key;
+            }
+        };
+        static constexpr int entrySize = 16;
+
+        struct WeightedMove{
+            Move move;
+            uint16_t weight;
+        };
+
+        static void writeEntry(std::ostream& stream, Entry const& entry);
+        static bool readEntry(std::istream& stream, Entry& entry);
+
+        /**
+         * @brief Open a book file for probing.
+         * 
+         * @param path the path of the .bin file
+         */
+        void open(std::string const& path);
+
+        void close(){
+            file.close();
+            numEntries = 0;
+        }
+
+        constexpr bool isOpen() const { return numEntries != 0; }
+
+        /**
+         * @brief Get all raw entries for a key using binary search.
+         * 
+         * @param key the zobrist hash of the position
+         * @return std::vector<Entry> the entries
+         */
+        std::vector<Entry> getEntries(uint64_t key);
+
+        /**
+         * @brief Get all book moves that are legal in the given position.
+         * 
+         * @param board the position to probe
+         * @param generator the move generator
+         * @return std::vector<WeightedMove> the moves including all flags
+         */
+        std::vector<WeightedMove> getMoves(Board const& board, MoveGenerator& generator);
+
+    private:
+        Entry readEntryAt(uint64_t index);
+
+        std::ifstream file;
+        uint64_t numEntries = 0;
+};
+
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace Thera{
+
+#ifdef THERA_SEARCH_TREE_DUMP
+inline constexpr bool isSearchTreeDumpEnabled = true;
+#else
+inline constexpr bool isSearchTreeDumpEnabled = false;
+#endif
+
+/**
+ * @brief Writes the nodes visited by the search into a binary file for offline analysis.
+ *
+ * The search only records nodes when built with THERA_SEARCH_TREE_DUMP, otherwise the calls are compiled out.
+ * Every thread collects its records in its own buffer and appends them to the file in blocks.
+ * The file is a plain sequence of Records in host byte order, children are written before their parents.
+ */
+class SearchTreeDump{
+    public:
+        struct Record{
+            enum class NodeType : uint8_t{
+                PV,
+                NonPV,
+                Quiescence,
+            };
+
+            /// the node didn't cut off, so all moves were searched
+            static constexpr int16_t noCutoff = -1;
+            /// the node was cut off by ProbCut before searching any move
+            static constexpr int16_t probCutCutoff = -2;
+            /// the quiescence node was cut off by its static evaluation
+            static constexpr int16_t standPatCutoff = -3;
+            /// the node returned a transposition table entry without searching, its static evaluation isn't computed
+            static constexpr int16_t ttCutoff = -4;
+            /// the node is a draw by repetition, its static evaluation isn't computed
+            static constexpr int16_t repetitionCutoff = -5;
+
+            int32_t alpha = 0;
+            int32_t beta = 0;
+            int32_t staticEval = 0;
+            int32_t result = 0;
+            /// the move leading to the node as encoded by Move::encode, 0 at the root
+            uint16_t move = 0;
+            /// the index of the move causing the cutoff in the searched order, or one of the constants above
+            int16_t cutoffMoveIndex = noCutoff;
+            uint8_t ply = 0;
+            int8_t depth = 0;
+            NodeType type = NodeType::PV;
+            uint8_t padding = 0;
+        };
+        static_assert(sizeof(Record) == 24, "The record layout is part of the file format");
+
+        /**
+         * @brief Start writing records to a file, replacing its contents.
+         *
+         * @param path the path of the dump file
+         */
+        static void open(std::string const& path);
+
+        /**
+         * @brief Flush the buffer of the calling thread and close the file.
+         *
+         * Records still buffered by other threads are discarded, so their searches should have finished.
+         */
+        static void close();
+
+        static bool isOpen();
+
+        /**
+         * @brief Remember the move made at a ply, so the record of the resulting node can contain it.
+         *
+         * @param ply the ply of the node the move is made from
+         * @param move the encoded move
+         */
+        static void setMove(int ply, uint16_t move);
+
+        /**
+         * @brief Add a record to the buffer of the calling thread. Its move is filled in from the moves set with setMove.
+         *
+         * @param record the record
+         */
+        static void write(Record record);
+
+        /**
+         * @brief Write the buffer of the calling thread to the file.
+         *
+         */
+        static void flush();
+};
+
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "Thera/Coordinate.hpp"
+
+#include <cstdint>
+
+namespace Thera{
+
+/**
+ * @brief A square on the board stored as a plain 0-63 index.
+ *
+ * Used by the move generator, moves and the board, where squares are mostly converted to bitboard indices.
+ * File and rank are derived from the index when needed.
+ * Coordinate remains the type used for UI and notation code and converts implicitly.
+ *
+ */
+struct Square{
+    uint8_t index = 0;
+
+    constexpr Square(){}
+    constexpr explicit Square(uint8_t index): index(index){}
+    constexpr explicit Square(uint8_t file, uint8_t rank): index(file + rank*8){}
+    constexpr Square(Coordinate coordinate): index(coordinate.getIndex64()){}
+
+    /**
+     * @brief Get the 0-63 index.
+     *
+     * @return constexpr uint8_t index into array of size 64
+     */
+    constexpr uint8_t getIndex64() const{
+        return index;
+    }
+
+    /**
+     * @brief Get the file (0 for the a-file, 7 for the h-file).
+     *
+     */
+    constexpr uint8_t getFile() const{
+        return index & 7;
+    }
+
+    /**
+     * @brief Get the rank (0 for the first rank, 7 for the eighth rank).
+     *
+     */
+    constexpr uint8_t getRank() const{
+        return index >> 3;
+    }
+
+    constexpr Coordinate toCoordinate() const{
+        return Coordinate(index);
+    }
+
+    /**
+     * @brief Apply an offset to a square.
+     *
+     * The offset is a 0-63 index difference (see DirectionIndex64), so the caller has to avoid wrapping around the board.
+     *
+     */
+    constexpr Square operator + (int offset) const{
+        return Square(static_cast<uint8_t>(index + offset));
+    }
+
+    /**
+     * @brief Apply an offset to a square.
+     *
+     */
+    constexpr Square operator - (int offset) const{
+        return Square(static_cast<uint8_t>(index - offset));
+    }
+
+    constexpr bool operator == (Square other) const{
+        return index == other.index;
+    }
+    constexpr bool operator < (Square other) const{
+        return index < other.index;
+    }
+
+    #define defSq(NAME) static const Square NAME;
+    #define defRow(NAME) defSq(NAME##1) defSq(NAME##2) defSq(NAME##3) defSq(NAME##4) defSq(NAME##5) defSq(NAME##6) defSq(NAME##7) defSq(NAME##8)
+
+    defRow(a)
+    defRow(b)
+    defRow(c)
+    defRow(d)
+    defRow(e)
+    defRow(f)
+    defRow(g)
+    defRow(h)
+
+    #undef defSq
+    #undef defRow
+};
+
+#define defSq(NAME) inline constexpr Square Square::NAME = Square(static_cast<uint8_t>(SquareIndex64::NAME));
+#define defRow(NAME) defSq(NAME##1) defSq(NAME##2) defSq(NAME##3) defSq(NAME##4) defSq(NAME##5) defSq(NAME##6) defSq(NAME##7) defSq(NAME##8)
+
+defRow(a)
+defRow(b)
+defRow(c)
+defRow(d)
+defRow(e)
+defRow(f)
+defRow(g)
+defRow(h)
+
+#undef defSq
+#undef defRow
+
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <atomic>
+#include <exception>
+
+namespace Thera{
+
+/**
+ * @brief A pool of persistent worker threads.
+ * 
+ * Workers briefly spin for new tasks after finishing one and are parked on a condition variable
+ * afterwards. All waits use predicates, so no task can get lost by notifying too early.
+ */
+class ThreadPool{
+    public:
+        /**
+         * @brief A task. It receives the index of the worker executing it.
+         */
+        using Task = std::function<void(int workerIndex)>;
+
+        /**
+         * @param numThreads the number of worker threads
+         * @param pinToNumaNodes pin the workers to NUMA nodes, grouped evenly per node
+         */
+        explicit ThreadPool(int numThreads=1, bool pinToNumaNodes=false);
+        ~ThreadPool();
+
+        ThreadPool(ThreadPool const&) = delete;
+        ThreadPool& operator = (ThreadPool const&) = delete;
+
+        /**
+         * @brief Recreate the workers. Waits for all tasks to finish first.
+         * 
+         * @param numThreads the number of worker threads
+         * @param pinToNumaNodes pin the workers to NUMA nodes, grouped evenly per node
+         */
+        void resize(int numThreads, bool pinToNumaNodes=false);
+
+        int getNumThreads() const { return workers.size(); }
+
+        /**
+         * @brief Run a task on any worker.
+         * 
+         * @param task the task
+         */
+        void submit(Task task);
+
+        /**
+         * @brief Run a task once on every worker.
+         * 
+         * @param task the task
+         */
+        void submitToAll(Task task);
+
+        /**
+         * @brief Wait for all submitted tasks to finish.
+         * 
+         * Rethrows the first exception thrown by a task.
+         */
+        void wait();
+
+        /**
+         * @brief Is any task queued or running.
+         */
+        bool isBusy();
+
+    private:
+        void workerFunction(int workerIndex, bool pinToNumaNodes);
+        bool hasTaskFor(int workerIndex) const;
+        void stopWorkers();
+
+        static constexpr int spinIterations = 2000;
+
+        std::vector<std::thread> workers;
+        std::vector<std::deque<Task>> workerQueues;
+        std::deque<Task> sharedQueue;
+
+        std::mutex mutex;
+        std::condition_variable taskAvailableCond;
+        std::condition_variable allDoneCond;
+        std::atomic<int> numPendingTasks = 0;
+        int numRunningTasks = 0;
+        bool shouldExit = false;
+        std::exception_ptr firstException;
+};
+
+}
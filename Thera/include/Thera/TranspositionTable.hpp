@@ -2,30 +2,171 @@
 
 #include "Thera/Board.hpp"
 #include "Thera/search.hpp"
+#include "Thera/Utils/Memory.hpp"
 
-#include <unordered_map>
 #include <optional>
+#include <cstdint>
+#include <array>
+#include <functional>
+#include <string>
+#include <atomic>
 
 namespace Thera{
     
+/**
+ * @brief A fixed size hash table storing search results.
+ * 
+ * Entries are grouped into cache line sized buckets. The memory is backed by huge pages
+ * if possible, since probes are random and would otherwise cause many TLB misses.
+ */
 class TranspositionTable{
     public:
+        /**
+         * @brief A single entry.
+         * 
+         * The key is stored xor'ed with the data, so entries torn by concurrent writes
+         * from multiple search threads fail the key comparison instead of returning wrong data.
+         */
         struct Entry{
-            enum class Flag{
+            enum class Flag : uint8_t{
                 Exact,
                 LowerBound,
                 UpperBound,
-            } flag;
-            int eval;
-            int depth;
+            };
+
+            struct Data{
+                int32_t eval;
+                int16_t depth;
+                Flag flag;
+                // the search that stored the entry, see newSearch
+                uint8_t generation = 0;
+            };
+            static_assert(sizeof(Data) == 8, "TT entry data should fit into 64 bits");
+
+            uint64_t keyXorData;
+            uint64_t data;
         };
+        static_assert(sizeof(Entry) == 16, "TT entries should be 16 bytes");
+
+        struct alignas(64) Bucket{
+            std::array<Entry, 4> entries;
+        };
+
+        static constexpr size_t defaultSizeMB = 16;
+
+        /**
+         * @param sizeMB the size of the table in MiB
+         */
+        TranspositionTable(size_t sizeMB = defaultSizeMB);
+
+        /**
+         * @brief Reallocate the table. All entries are lost.
+         * 
+         * @param sizeMB the size of the table in MiB (rounded down to a power of two)
+         * @param prefault zero the table immediately using multiple threads, instead of faulting pages in during the search
+         * @param interleaveNumaNodes spread the table across the memory of all NUMA nodes
+         */
+        void resize(size_t sizeMB, bool prefault=true, bool interleaveNumaNodes=false);
+
+        /**
+         * @brief Use a table shared with other processes that open the same name. The current entries are lost.
+         * 
+         * The entries are written using the same lockless scheme as between threads, so no further synchronization is needed.
+         * Throws std::runtime_error if the shared memory can't be used, the current table is kept in that case.
+         * 
+         * @param name a POSIX shared memory name ("/name") or a file path, see Utils::LargeMemoryBlock::openShared
+         * @param sizeMB the size of the table in MiB (rounded down to a power of two), has to be the same in all processes
+         */
+        void openShared(std::string const& name, size_t sizeMB);
+
+        /**
+         * @brief Remove all entries.
+         * 
+         * @param numThreads the number of threads used for clearing
+         */
+        void clear(int numThreads);
+
+        /**
+         * @brief Start a new search. Entries of older searches are preferred for replacement, even if they are deeper.
+         * 
+         * May be called while other threads store entries. Shared tables don't age their entries,
+         * since every process would count its own searches.
+         */
+        void newSearch(){
+            if (!shared) generation.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * @return true if the table is shared with other processes, see openShared
+         */
+        bool isShared() const { return shared; }
+
+        constexpr size_t getNumBuckets() const { return numBuckets; }
+
+        /**
+         * @brief Start loading the bucket of a position into the cache.
+         * 
+         * Should be called as early as possible, so the cache miss overlaps with other work before the probe.
+         * 
+         * @param key the zobrist hash of the position that will be probed
+         */
+        void prefetch(uint64_t key) const{
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(&getBucket(key));
+#endif
+        }
 
         void addEntry(Board const& board, int eval, NegamaxState nstate);
 
+        /**
+         * @brief Store an entry using the normal replacement scheme.
+         * 
+         * @param key the zobrist hash of the position
+         * @param data the data to store, it is marked as belonging to the current search
+         */
+        void storeEntry(uint64_t key, Entry::Data data);
+
+        /**
+         * @brief Get notified about new entries of at least the given depth. Called from the searching threads.
+         * 
+         * @param minDepth the minimum depth of reported entries
+         * @param listener the listener or an empty function to remove it
+         */
+        void setDeepEntryListener(int minDepth, std::function<void(uint64_t key, Entry::Data data)> listener);
+
         std::optional<int> readPotentialEntry(Board const& board, NegamaxState& nstate);
 
     private:
-        std::unordered_map<uint64_t, Entry> internalTable;
+        /**
+         * @brief Atomically read an entry.
+         * 
+         * @param entry the entry to read
+         * @param key the key stored in the entry, if the entry is intact
+         * @return Entry::Data the data of the entry
+         */
+        static Entry::Data loadEntry(Entry& entry, uint64_t& key);
+
+        /**
+         * @brief Atomically write an entry.
+         * 
+         * @param entry the entry to overwrite
+         * @param key the key to store
+         * @param data the data to store
+         */
+        static void storeEntry(Entry& entry, uint64_t key, Entry::Data data);
+
+        Bucket& getBucket(uint64_t key) const{
+            return buckets[key & (numBuckets - 1)];
+        }
+
+        Utils::LargeMemoryBlock memory;
+        Bucket* buckets = nullptr;
+        size_t numBuckets = 0;
+        bool shared = false;
+        std::atomic<uint8_t> generation = 0;
+
+        int deepEntryMinDepth = 0;
+        std::function<void(uint64_t key, Entry::Data data)> deepEntryListener;
 };
 
 }
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <bit>
+#include <stdexcept>
+
+namespace Thera::Utils{
+
+/**
+ * @brief A fixed capacity lock-free queue for many producers and a single consumer.
+ *
+ * Every slot carries a sequence number telling whether it is ready to be written or read,
+ * so producers only contend on a single atomic increment and never wait for the consumer.
+ */
+template<typename T>
+class BoundedQueue{
+    public:
+        /**
+         * @param capacity the maximum number of queued items, has to be a power of two
+         */
+        BoundedQueue(size_t capacity): slots(std::make_unique<Slot[]>(capacity)), capacity(capacity){
+            if (!std::has_single_bit(capacity)) throw std::invalid_argument("Queue capacity has to be a power of two");
+            for (size_t i=0; i<capacity; i++){
+                slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+        BoundedQueue(BoundedQueue const&) = delete;
+        BoundedQueue& operator = (BoundedQueue const&) = delete;
+
+        /**
+         * @brief Append an item. May be called from any thread.
+         *
+         * @param item the item
+         * @return false if the queue is full and the item was dropped
+         */
+        bool tryPush(T const& item){
+            uint64_t position = tail.load(std::memory_order_relaxed);
+            while (true){
+                Slot& slot = slots[position & (capacity - 1)];
+                const int64_t difference = int64_t(slot.sequence.load(std::memory_order_acquire) - position);
+                if (difference == 0){
+                    if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)){
+                        slot.item = item;
+                        slot.sequence.store(position + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (difference < 0){
+                    // the consumer hasn't freed the slot of the previous round yet
+                    return false;
+                }
+                else{
+                    position = tail.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /**
+         * @brief Remove the oldest item. May only be called from one thread at a time.
+         *
+         * @param item receives the item
+         * @return false if the queue is empty
+         */
+        bool tryPop(T& item){
+            Slot& slot = slots[head & (capacity - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != head + 1) return false;
+
+            item = slot.item;
+            slot.sequence.store(head + capacity, std::memory_order_release);
+            head++;
+            return true;
+        }
+
+    private:
+        struct Slot{
+            std::atomic<uint64_t> sequence;
+            T item;
+        };
+
+        std::unique_ptr<Slot[]> slots;
+        const size_t capacity;
+        std::atomic<uint64_t> tail = 0;
+        uint64_t head = 0;
+};
+
+}
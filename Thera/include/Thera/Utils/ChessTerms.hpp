@@ -3,6 +3,7 @@
 #include "Thera/Piece.hpp"
 #include "Thera/Utils/Math.hpp"
 #include "Thera/Coordinate.hpp"
+#include "Thera/Square.hpp"
 
 #include <string>
 #include <array>
@@ -50,7 +51,7 @@ Coordinate squareFromAlgebraicNotation(std::string const& str);
  * @param square 
  * @return std::string 
  */
-std::string squareToAlgebraicNotation(Coordinate square);
+std::string squareToAlgebraicNotation(Square square);
 
 /**
  * @brief Convert a piece color to a human readable string. ("white", "black")
@@ -78,8 +79,8 @@ std::string pieceTypeToString(PieceType type, bool isPlural=false);
 std::string pieceToString(Piece piece, bool isPlural=false);
 
 
-constexpr int manhattanDistance(Coordinate pos1, Coordinate pos2){
-    return std::abs(int(pos1.x) - int(pos2.x)) + std::abs(int(pos1.y) - int(pos2.y));
+constexpr int manhattanDistance(Square pos1, Square pos2){
+    return std::abs(int(pos1.getFile()) - int(pos2.getFile())) + std::abs(int(pos1.getRank()) - int(pos2.getRank()));
 }
 static_assert(manhattanDistance(Square::a1, Square::a1) == 0);
 static_assert(manhattanDistance(Square::a1, Square::h8) == 14);
@@ -94,8 +95,8 @@ static_assert(manhattanDistance(Square::h8, Square::h1) == 7);
 static_assert(manhattanDistance(Square::h1, Square::a1) == 7);
 static_assert(manhattanDistance(Square::h8, Square::a8) == 7);
 
-constexpr int chebyshevDistance(Coordinate pos1, Coordinate pos2){
-    return std::max(std::abs(int(pos1.x) - int(pos2.x)), std::abs(int(pos1.y) - int(pos2.y)));
+constexpr int chebyshevDistance(Square pos1, Square pos2){
+    return std::max(std::abs(int(pos1.getFile()) - int(pos2.getFile())), std::abs(int(pos1.getRank()) - int(pos2.getRank())));
 }
 
 static_assert(chebyshevDistance(Square::a1, Square::a1) == 0);
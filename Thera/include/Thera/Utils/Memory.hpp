@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace Thera::Utils{
+
+/**
+ * @brief A large, zero initialized block of memory backed by huge pages if possible.
+ * 
+ * On Linux, explicit huge pages (MAP_HUGETLB) are tried first. If none are available,
+ * the block is aligned to the huge page size and transparent huge pages are requested
+ * using madvise(MADV_HUGEPAGE). Other platforms use a plain aligned allocation.
+ * Pages are only backed by physical memory on first access, unless the block gets cleared.
+ */
+class LargeMemoryBlock{
+    public:
+        static constexpr size_t hugePageSize = 2 * 1024 * 1024;
+
+        LargeMemoryBlock() = default;
+        /**
+         * @param size the size in bytes
+         * @param interleaveNumaNodes spread the pages evenly across all NUMA nodes
+         */
+        explicit LargeMemoryBlock(size_t size, bool interleaveNumaNodes=false);
+        ~LargeMemoryBlock();
+
+        LargeMemoryBlock(LargeMemoryBlock const&) = delete;
+        LargeMemoryBlock& operator = (LargeMemoryBlock const&) = delete;
+        LargeMemoryBlock(LargeMemoryBlock&& other);
+        LargeMemoryBlock& operator = (LargeMemoryBlock&& other);
+
+        /**
+         * @brief Map a block that is shared with other processes mapping the same name. Only supported on Linux.
+         * 
+         * Names of the form "/name" refer to POSIX shared memory segments, all others to files.
+         * A new segment or file is created zero initialized. It persists until it is deleted,
+         * e.g. from /dev/shm, so processes started later still find its contents.
+         * Throws std::runtime_error if it can't be mapped or already exists with a different size.
+         * 
+         * @param name the name of the shared memory segment or the path of the file
+         * @param size the size in bytes
+         * @return LargeMemoryBlock the mapped block
+         */
+        static LargeMemoryBlock openShared(std::string const& name, size_t size);
+
+        constexpr void* data() const { return alignedData; }
+        constexpr size_t size() const { return usableSize; }
+
+        /**
+         * @brief Was the memory allocated using explicit huge pages.
+         */
+        constexpr bool usesExplicitHugePages() const { return explicitHugePages; }
+
+        /**
+         * @brief Zero the memory using multiple threads.
+         * 
+         * Touching every page also faults them in, so the first accesses afterwards don't have to.
+         * 
+         * @param numThreads the number of threads to use
+         */
+        void clear(int numThreads);
+
+    private:
+        void release();
+
+        void* mapping = nullptr;
+        size_t mappingSize = 0;
+        void* alignedData = nullptr;
+        size_t usableSize = 0;
+        bool explicitHugePages = false;
+};
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+#include <string>
+
+namespace Thera::Utils{
+
+/**
+ * @brief A NUMA node and the logical CPUs belonging to it.
+ */
+struct NumaNode{
+    int id;
+    std::vector<int> cpus;
+};
+
+/**
+ * @brief Parse a Linux CPU or node list like "0-3,8-11".
+ * 
+ * @param list the list to parse
+ * @return std::vector<int> all contained numbers
+ */
+std::vector<int> parseCPUList(std::string const& list);
+
+/**
+ * @brief Read the NUMA topology from /sys.
+ * 
+ * Systems without NUMA information are reported as a single node containing all CPUs.
+ * 
+ * @return std::vector<NumaNode> all online nodes that have CPUs
+ */
+std::vector<NumaNode> getNumaTopology();
+
+/**
+ * @brief Get the node a thread should run on, so that threads are grouped evenly per node.
+ * 
+ * Threads [k*numThreads/numNodes, (k+1)*numThreads/numNodes) are assigned to node k.
+ * 
+ * @param threadIndex the index of the thread
+ * @param numThreads the total number of threads
+ * @param topology the NUMA topology
+ * @return NumaNode const& the node to run on
+ */
+NumaNode const& getNodeForThread(int threadIndex, int numThreads, std::vector<NumaNode> const& topology);
+
+/**
+ * @brief Restrict the calling thread to a set of CPUs. Does nothing on platforms other than Linux.
+ * 
+ * @param cpus the CPUs to run on
+ * @return bool did pinning succeed
+ */
+bool pinCurrentThread(std::vector<int> const& cpus);
+
+/**
+ * @brief Interleave the pages of a memory range across all NUMA nodes.
+ * 
+ * Has to be called before the pages are first touched. Does nothing on platforms other than Linux.
+ * 
+ * @param memory the start of the range (page aligned)
+ * @param size the size of the range
+ * @return bool was the memory policy applied
+ */
+bool interleaveMemoryAcrossNodes(void* memory, size_t size);
+
+}
@@ -3,6 +3,7 @@
 #include "Thera/Move.hpp"
 #include "Thera/Board.hpp"
 #include "Thera/MoveGenerator.hpp"
+#include "Thera/ThreadPool.hpp"
 
 #include <functional>
 
@@ -63,4 +64,17 @@ PerftResult perft_instrumented(Board& board, MoveGenerator& generator, int depth
  * @return PerftResult the result
  */
 PerftResult perft(Board& board, MoveGenerator& generator, int depth, bool bulkCounting);
+
+/**
+ * @brief Run the perft algorithm on a given board using a thread pool.
+ * 
+ * Every root move is searched as a separate task on its own copy of the board.
+ * 
+ * @param board the board to run perft for
+ * @param depth the maximum search depth
+ * @param bulkCounting is bulk counting allowed
+ * @param pool the thread pool to run on
+ * @return PerftResult the result
+ */
+PerftResult perft(Board const& board, int depth, bool bulkCounting, ThreadPool& pool);
 }
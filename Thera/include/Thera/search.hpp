@@ -15,6 +15,10 @@
 
 namespace Thera{
 
+class AnalysisCache;
+class TranspositionTable;
+class ThreadPool;
+
 static constexpr int evalInfinity = std::numeric_limits<int>::max();
 
 struct SearchStopException : public std::exception{};
@@ -23,6 +27,8 @@ struct EvaluatedMove{
     Move move;
     int eval = -std::numeric_limits<int>::infinity();
     std::optional<Move> ponderMove;
+    /// the nodes searched below this move in the last iteration
+    uint64_t nodesSearched = 0;
 
     bool operator < (EvaluatedMove other) const{
         if (eval != other.eval){
@@ -35,20 +41,28 @@ struct SearchResult{
     std::vector<EvaluatedMove> moves;
     int depthReached=0;
     bool isMate=false;
-    int maxEval;
+    int maxEval=0;
     uint64_t nodesSearched=0;
+    /// the share of the nodes of the last iteration spent below the best move, a low share means the best move is uncertain
+    float bestMoveEffort=0;
 };
 
 struct NegamaxState{
     int depth;
     int alpha;
     int beta;
+    /// is this node on the expected principal variation, so reached through the first move at every ply
+    bool isPVNode = true;
+    /// the distance to the root
+    uint8_t ply = 0;
 
     NegamaxState nextDepth(int searchExtensions=0){
         return NegamaxState{
             .depth = depth-1+searchExtensions,
             .alpha = -beta,
             .beta = -alpha,
+            .isPVNode = isPVNode,
+            .ply = static_cast<uint8_t>(ply + 1),
         };
     }
     
@@ -59,9 +73,34 @@ struct NegamaxState{
     }
 };
 
+/**
+ * @brief How helper threads cooperate with the main search thread.
+ */
+enum class ParallelSearchMode{
+    /// all threads search independently and only share the transposition table
+    LazySMP,
+    /// like LazySMP, but threads defer moves that another thread is currently searching
+    ABDADA,
+};
+
 int evaluate(Board& board, MoveGenerator& generator);
 
-SearchResult search(Board& board, MoveGenerator& generator, int depth, std::optional<std::chrono::milliseconds> maxSearchTime, std::atomic<bool> const& searchWasTerminated, std::function<void(SearchResult const&)> iterationEndCallback);
+/**
+ * @brief Search the best move using iterative deepening.
+ * 
+ * @param board the position to search
+ * @param generator the move generator
+ * @param transpositionTable the transposition table, which is kept between searches
+ * @param depth the maximum depth
+ * @param maxSearchTime the time after which the search is stopped
+ * @param searchWasTerminated stops the search when set
+ * @param iterationEndCallback called after every completed iteration
+ * @param analysisCache an optional persistent cache that is consulted before and updated after searching
+ * @param helperPool an optional pool whose workers all run helper searches sharing the transposition table
+ * @param parallelSearchMode how the helper threads cooperate
+ * @return SearchResult the result of the deepest completed iteration
+ */
+SearchResult search(Board& board, MoveGenerator& generator, TranspositionTable& transpositionTable, int depth, std::optional<std::chrono::milliseconds> maxSearchTime, std::atomic<bool> const& searchWasTerminated, std::function<void(SearchResult const&)> iterationEndCallback, AnalysisCache* analysisCache = nullptr, ThreadPool* helperPool = nullptr, ParallelSearchMode parallelSearchMode = ParallelSearchMode::LazySMP);
 
 EvaluatedMove getRandomBestMove(SearchResult const& moves);
 
@@ -0,0 +1,269 @@
+#include "Thera/AnalysisCache.hpp"
+#include "Thera/Move.hpp"
+
+#include <stdexcept>
+#include <vector>
+#include <bit>
+#include <cstring>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+
+namespace Thera{
+
+// version 2 stores moves as encoded by Move::encode
+static constexpr uint64_t logMagic   = 0x324C47414C524854; // "THRLAGL2"
+static constexpr uint64_t indexMagic = 0x3158444E49524854; // "THRINDX1"
+static constexpr uint64_t minIndexCapacity = 1 << 16;
+
+struct AnalysisCache::IndexHeader{
+    uint64_t magic;
+    uint64_t capacity;
+    uint64_t numEntries;
+    uint64_t indexedLogSize;
+};
+
+struct AnalysisCache::IndexSlot{
+    uint64_t key;
+    uint64_t logOffset; // 0 marks an empty slot since the log starts with its magic
+};
+
+// on-disk layout of a single log record
+struct LogRecord{
+    uint64_t key;
+    int32_t eval;
+    int16_t depth;
+    uint16_t move;
+    uint8_t flag;
+    uint8_t padding[7];
+};
+static_assert(sizeof(LogRecord) == 24, "Log records have to be tightly packed");
+
+static uint64_t getFileSize(int file){
+    struct stat status;
+    if (fstat(file, &status) != 0) throw std::runtime_error("Unable to stat analysis cache file");
+    return status.st_size;
+}
+
+AnalysisCache::~AnalysisCache(){
+    close();
+}
+
+void AnalysisCache::open(std::string const& path){
+    close();
+
+    logFile = ::open((path + ".log").c_str(), O_RDWR | O_CREAT, 0644);
+    if (logFile == -1) throw std::runtime_error("Unable to open \"" + path + ".log\"");
+    if (flock(logFile, LOCK_EX | LOCK_NB) != 0){
+        close();
+        throw std::runtime_error("Analysis cache \"" + path + "\" is used by another process");
+    }
+
+    const uint64_t logSize = getFileSize(logFile);
+    if (logSize == 0){
+        if (pwrite(logFile, &logMagic, sizeof(logMagic), 0) != sizeof(logMagic)){
+            close();
+            throw std::runtime_error("Unable to initialize \"" + path + ".log\"");
+        }
+    }
+    else{
+        uint64_t magic = 0;
+        if (pread(logFile, &magic, sizeof(magic), 0) != sizeof(magic) || magic != logMagic){
+            close();
+            throw std::runtime_error("\"" + path + ".log\" isn't an analysis cache");
+        }
+
+        // drop a partially written record (e.g. after a crash)
+        const uint64_t partialBytes = (logSize - sizeof(logMagic)) % sizeof(LogRecord);
+        if (partialBytes && ftruncate(logFile, logSize - partialBytes) != 0){
+            close();
+            throw std::runtime_error("Unable to repair \"" + path + ".log\"");
+        }
+    }
+
+    indexPath = path + ".idx";
+    indexFile = ::open(indexPath.c_str(), O_RDWR | O_CREAT, 0644);
+    if (indexFile == -1){
+        close();
+        throw std::runtime_error("Unable to open \"" + indexPath + "\"");
+    }
+
+    // the files have to be closed if loading the index fails, so the lock is released
+    try{
+        loadIndex();
+    }
+    catch(...){
+        close();
+        throw;
+    }
+}
+
+void AnalysisCache::loadIndex(){
+    // reuse the existing index if it is valid
+    IndexHeader existingHeader = {};
+    const uint64_t indexSize = getFileSize(indexFile);
+    const uint64_t currentLogSize = getFileSize(logFile);
+    if (indexSize >= sizeof(IndexHeader) && pread(indexFile, &existingHeader, sizeof(existingHeader), 0) == sizeof(existingHeader)){
+        const bool isValid = existingHeader.magic == indexMagic
+            && std::has_single_bit(existingHeader.capacity)
+            && indexSize == sizeof(IndexHeader) + existingHeader.capacity * sizeof(IndexSlot)
+            && existingHeader.indexedLogSize >= sizeof(logMagic)
+            && existingHeader.indexedLogSize <= currentLogSize;
+        const uint64_t numNewRecords = (currentLogSize - existingHeader.indexedLogSize) / sizeof(LogRecord);
+
+        if (isValid && (existingHeader.numEntries + numNewRecords) * 2 <= existingHeader.capacity){
+            mapIndex(existingHeader.capacity);
+            indexLogRange(header->indexedLogSize, currentLogSize);
+            return;
+        }
+    }
+
+    rebuildIndex(minIndexCapacity);
+}
+
+void AnalysisCache::close(){
+    unmapIndex();
+    if (indexFile != -1) ::close(indexFile);
+    if (logFile != -1) ::close(logFile);
+    indexFile = -1;
+    logFile = -1;
+}
+
+void AnalysisCache::mapIndex(uint64_t capacity){
+    unmapIndex();
+
+    mappedSize = sizeof(IndexHeader) + capacity * sizeof(IndexSlot);
+    if (getFileSize(indexFile) != mappedSize && ftruncate(indexFile, mappedSize) != 0)
+        throw std::runtime_error("Unable to resize \"" + indexPath + "\"");
+
+    void* memory = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, indexFile, 0);
+    if (memory == MAP_FAILED){
+        mappedSize = 0;
+        throw std::runtime_error("Unable to map \"" + indexPath + "\"");
+    }
+
+    header = static_cast<IndexHeader*>(memory);
+    slots = reinterpret_cast<IndexSlot*>(static_cast<char*>(memory) + sizeof(IndexHeader));
+}
+
+void AnalysisCache::unmapIndex(){
+    if (header){
+        msync(header, mappedSize, MS_SYNC);
+        munmap(header, mappedSize);
+    }
+    header = nullptr;
+    slots = nullptr;
+    mappedSize = 0;
+}
+
+void AnalysisCache::rebuildIndex(uint64_t capacity){
+    const uint64_t logSize = getFileSize(logFile);
+    const uint64_t numRecords = (logSize - sizeof(logMagic)) / sizeof(LogRecord);
+    capacity = std::max({capacity, minIndexCapacity, std::bit_ceil(numRecords * 2)});
+
+    // drop the old contents
+    unmapIndex();
+    if (ftruncate(indexFile, 0) != 0)
+        throw std::runtime_error("Unable to clear \"" + indexPath + "\"");
+    mapIndex(capacity);
+
+    header->magic = indexMagic;
+    header->capacity = capacity;
+    header->numEntries = 0;
+    header->indexedLogSize = sizeof(logMagic);
+    indexLogRange(sizeof(logMagic), logSize);
+}
+
+void AnalysisCache::indexLogRange(uint64_t begin, uint64_t end){
+    static constexpr int recordsPerChunk = 4096;
+    std::vector<LogRecord> records(recordsPerChunk);
+
+    uint64_t offset = begin;
+    while (offset + sizeof(LogRecord) <= end){
+        const uint64_t numRecords = std::min<uint64_t>(recordsPerChunk, (end - offset) / sizeof(LogRecord));
+        const ssize_t bytes = pread(logFile, records.data(), numRecords * sizeof(LogRecord), offset);
+        if (bytes < 0 || uint64_t(bytes) != numRecords * sizeof(LogRecord)) throw std::runtime_error("Unable to read analysis cache log");
+
+        for (uint64_t i=0; i<numRecords; i++){
+            Entry entry;
+            entry.key = records.at(i).key;
+            entry.depth = records.at(i).depth;
+            insertIntoIndex(entry, offset + i * sizeof(LogRecord));
+        }
+        offset += numRecords * sizeof(LogRecord);
+    }
+    header->indexedLogSize = offset;
+}
+
+void AnalysisCache::insertIntoIndex(Entry const& entry, uint64_t logOffset){
+    const uint64_t mask = header->capacity - 1;
+    for (uint64_t i = entry.key & mask;; i = (i+1) & mask){
+        IndexSlot& slot = slots[i];
+        if (slot.logOffset == 0){
+            slot.key = entry.key;
+            slot.logOffset = logOffset;
+            header->numEntries++;
+            return;
+        }
+        if (slot.key == entry.key){
+            if (entry.depth >= readLogRecord(slot.logOffset).depth)
+                slot.logOffset = logOffset;
+            return;
+        }
+    }
+}
+
+AnalysisCache::Entry AnalysisCache::readLogRecord(uint64_t logOffset) const{
+    LogRecord record;
+    if (pread(logFile, &record, sizeof(record), logOffset) != sizeof(record))
+        throw std::runtime_error("Unable to read analysis cache log");
+
+    Entry entry;
+    entry.key = record.key;
+    entry.eval = record.eval;
+    entry.depth = record.depth;
+    entry.move = record.move;
+    entry.flag = static_cast<Entry::Flag>(record.flag);
+    return entry;
+}
+
+std::optional<AnalysisCache::Entry> AnalysisCache::read(uint64_t key) const{
+    if (!isOpen()) return {};
+
+    const uint64_t mask = header->capacity - 1;
+    for (uint64_t i = key & mask;; i = (i+1) & mask){
+        IndexSlot const& slot = slots[i];
+        if (slot.logOffset == 0) return {};
+        if (slot.key == key) return readLogRecord(slot.logOffset);
+    }
+}
+
+void AnalysisCache::write(Entry const& entry){
+    if (!isOpen()) return;
+
+    LogRecord record;
+    std::memset(&record, 0, sizeof(record));
+    record.key = entry.key;
+    record.eval = entry.eval;
+    record.depth = entry.depth;
+    record.move = entry.move;
+    record.flag = static_cast<uint8_t>(entry.flag);
+
+    const uint64_t logOffset = getFileSize(logFile);
+    if (pwrite(logFile, &record, sizeof(record), logOffset) != sizeof(record))
+        throw std::runtime_error("Unable to write analysis cache log");
+
+    if ((header->numEntries + 1) * 2 > header->capacity){
+        rebuildIndex(header->capacity * 2);
+    }
+    else{
+        insertIntoIndex(entry, logOffset);
+        header->indexedLogSize = logOffset + sizeof(record);
+    }
+}
+
+}
@@ -1,5 +1,6 @@
 #include "Thera/Board.hpp"
 #include "Thera/Move.hpp"
+#include "Thera/MoveGenerator.hpp"
 
 #include "Thera/Utils/Math.hpp"
 #include "Thera/Utils/ChessTerms.hpp"
@@ -15,13 +16,16 @@
 
 namespace Thera{
 
-Piece Board::at(Coordinate index) const{
-	for (auto piece : Utils::allPieces){
-		if (getBitboard(piece).isOccupied(index)){
-			return piece;
+Piece Board::at(Square index) const{
+	if (!getAllPieceBitboard().isOccupied(index)) return {PieceType::None, PieceColor::White};
+
+	const PieceColor color = getPieceBitboardForOneColor(PieceColor::White).isOccupied(index) ? PieceColor::White : PieceColor::Black;
+	for (auto type : {PieceType::Pawn, PieceType::Knight, PieceType::Bishop, PieceType::Rook, PieceType::Queen}){
+		if (getPieceTypeBitboard(type).isOccupied(index)){
+			return {type, color};
 		}
 	}
-	return {PieceType::None, PieceColor::White};
+	return {PieceType::King, color};
 }
 
 static std::string generateFenErrorText(std::string const& fen, int charIndex){
@@ -56,12 +60,11 @@ void Board::loadFromFEN(std::string fen){
 		}
 	}
 	zobristBlackToMove = distribution(randomGenerator);
-	currentState.zobristHash = 0;
+	plyStates.reset();
+	state().zobristHash = 0;
 
-	currentState.allPieceBitboard = Bitboard();
-	for (auto& bitboard : currentState.pieceBitboards){
-		bitboard = Bitboard();
-	}
+	state().pieceTypeBitboards.fill(Bitboard());
+	state().colorBitboards.fill(Bitboard());
 
 	uint8_t x = 0, y = 7;
 	int charIndex = -1;
@@ -95,24 +98,21 @@ void Board::loadFromFEN(std::string fen){
 	parse_turn:
 	charIndex++; // skip space
 
-	currentState.isWhiteToMove = true;
+	state().isWhiteToMove = true;
 	if (fen.at(charIndex) == 'w') ;
 	else if(fen.at(charIndex) == 'b') switchPerspective();
 	else
 		throw std::invalid_argument(generateFenErrorText(fen, charIndex));
 	charIndex += 2; // consume side to move and space
 
-	currentState.canBlackCastleLeft = false;
-	currentState.canBlackCastleRight = false;
-	currentState.canWhiteCastleLeft = false;
-	currentState.canWhiteCastleRight = false;
+	state().castlingRights = 0;
 
 	while (fen.at(charIndex) != ' '){
 		switch(fen.at(charIndex)){
-			case 'k': currentState.canBlackCastleRight = true; break;
-			case 'K': currentState.canWhiteCastleRight = true; break;
-			case 'q': currentState.canBlackCastleLeft = true; break;
-			case 'Q': currentState.canWhiteCastleLeft = true; break;
+			case 'k': state().castlingRights |= BoardState::BlackRight; break;
+			case 'K': state().castlingRights |= BoardState::WhiteRight; break;
+			case 'q': state().castlingRights |= BoardState::BlackLeft; break;
+			case 'Q': state().castlingRights |= BoardState::WhiteLeft; break;
 			case '-': charIndex++; goto parse_en_passant; // skip char since loop would normaly do that
 			default:
 				throw std::invalid_argument(generateFenErrorText(fen, charIndex));
@@ -127,13 +127,10 @@ void Board::loadFromFEN(std::string fen){
 		throw std::invalid_argument(generateFenErrorText(fen, charIndex));
 	}
 	if (fen.at(charIndex) == '-'){
-		currentState.hasEnPassant = false;
+		state().enPassantSquare = Square();
 	}
 	else{
-		currentState.enPassantSquareForFEN = Utils::squareFromAlgebraicNotation(fen.substr(charIndex, 2));
-		currentState.enPassantSquareToCapture = currentState.enPassantSquareForFEN;
-		currentState.enPassantSquareToCapture.y += (currentState.isWhiteToMove ? -1 : 1);
-		currentState.hasEnPassant = true;
+		state().enPassantSquare = Utils::squareFromAlgebraicNotation(fen.substr(charIndex, 2));
 		charIndex += 1;
 	}
 	charIndex += 2; // skip sth. and space
@@ -142,6 +139,8 @@ void Board::loadFromFEN(std::string fen){
 	// TODO: Implement move counters
 
 	while (!rewindStack.empty()) rewindStack.pop();
+	while (!attackTablesRewindStack.empty()) attackTablesRewindStack.pop();
+	if (attackTracking) refreshAttackTables();
 
 	numberOfPositionRepetitions.clear();
 	numberOfPositionRepetitions.insert({getCurrentHash(), 1});
@@ -185,20 +184,20 @@ std::string Board::storeToFEN() const{
 	}
 
 	fen += ' ';
-	fen += currentState.isWhiteToMove ? 'w' : 'b';
+	fen += state().isWhiteToMove ? 'w' : 'b';
 
 	fen += ' ';
-	if (currentState.canWhiteCastleLeft) fen += 'Q';
-	if (currentState.canWhiteCastleRight) fen += 'K';
-	if (currentState.canBlackCastleLeft) fen += 'q';
-	if (currentState.canBlackCastleRight) fen += 'k';
+	if (state().canWhiteCastleLeft()) fen += 'Q';
+	if (state().canWhiteCastleRight()) fen += 'K';
+	if (state().canBlackCastleLeft()) fen += 'q';
+	if (state().canBlackCastleRight()) fen += 'k';
 
-	if (!(currentState.canWhiteCastleLeft || currentState.canWhiteCastleRight || currentState.canBlackCastleLeft || currentState.canBlackCastleRight)){
+	if (!(state().canWhiteCastleLeft() || state().canWhiteCastleRight() || state().canBlackCastleLeft() || state().canBlackCastleRight())){
 		fen += '-';
 	}
 
 	fen += ' ';
-	if (currentState.hasEnPassant){
+	if (hasEnPassant()){
 		fen += Utils::squareToAlgebraicNotation(getEnPassantSquareForFEN());
 	}
 	else{
@@ -211,9 +210,12 @@ std::string Board::storeToFEN() const{
 	return fen;
 }
 
+template<MoveApplication application>
 void Board::applyMove(Move const& move){
 	// save the current state
-	rewindStack.push(currentState);
+	if constexpr (application == MoveApplication::CopyMake) plyStates.push();
+	else rewindStack.push(state());
+	if (attackTracking) attackTablesRewindStack.push(attackTables);
 
 	applyMoveStatic(move);
 
@@ -229,58 +231,77 @@ void Board::applyMove(Move const& move){
 	}
 }
 
+// castling rights that are kept when a piece moves from or to a square
+static constexpr std::array<uint8_t, 64> castlingRightsMasks = [](){
+	std::array<uint8_t, 64> masks;
+	masks.fill(0b1111);
+	// rook squares
+	masks.at(SquareIndex64::a1) &= ~Board::BoardState::WhiteLeft;
+	masks.at(SquareIndex64::h1) &= ~Board::BoardState::WhiteRight;
+	masks.at(SquareIndex64::a8) &= ~Board::BoardState::BlackLeft;
+	masks.at(SquareIndex64::h8) &= ~Board::BoardState::BlackRight;
+	// king squares
+	masks.at(SquareIndex64::e1) &= ~(Board::BoardState::WhiteLeft | Board::BoardState::WhiteRight);
+	masks.at(SquareIndex64::e8) &= ~(Board::BoardState::BlackLeft | Board::BoardState::BlackRight);
+	return masks;
+}();
+
 void Board::applyMoveStatic(Move const& move){
 	if(move.startIndex == move.endIndex) return;
 
-	removeCastlings(move.startIndex);
-	removeCastlings(move.endIndex);
-	
-	// remove pieces from bitboards
-	getPieceBitboardForOneColor(getColorToNotMove()).removePiece(move.endIndex);
-	removePiece(move.endIndex);
+	const uint8_t start = move.startIndex.getIndex64();
+	const uint8_t end = move.endIndex.getIndex64();
+	const PieceColor color = getColorToMove();
+	const PieceColor otherColor = getColorToNotMove();
+	const Bitboard occupiedBefore = getAllPieceBitboard();
+
+	state().castlingRights &= castlingRightsMasks[start] & castlingRightsMasks[end];
 	
+	// captures only touch the bitboards of the captured piece
+	if (getPieceBitboardForOneColor(otherColor).isOccupied(end)){
+		for (auto type : {PieceType::Pawn, PieceType::Knight, PieceType::Bishop, PieceType::Rook, PieceType::Queen, PieceType::King}){
+			if (!getPieceTypeBitboard(type).isOccupied(end)) continue;
 
-	// apply the move to the bitboards
-	currentState.allPieceBitboard.applyMove(move);
-	getPieceBitboardForOneColor(getColorToMove()).applyMove(move);
-	getBitboard(move.piece).applyMove(move);
-	currentState.zobristHash ^= zobristTable.at(move.startIndex.getIndex64()).at(move.piece.getRaw());
-	currentState.zobristHash ^= zobristTable.at(move.endIndex.getIndex64()).at(move.piece.getRaw());
+			togglePiece(move.endIndex, {type, otherColor});
+			break;
+		}
+	}
 
-	// promotion
+	// apply the move to the bitboards
+	togglePiece(move.startIndex, move.piece);
 	if (move.promotionType != PieceType::None){
-		removePiece(move.endIndex);
-		placePiece(move.endIndex, Piece(move.promotionType, getColorToMove()));
+		togglePiece(move.endIndex, {move.promotionType, color});
+	}
+	else{
+		togglePiece(move.endIndex, move.piece);
 	}
 
-	// en passant
 	if (move.isEnPassant){
-		removePiece(Coordinate(move.endIndex.x, move.startIndex.y));
-		currentState.hasEnPassant = false;
+		const Square capturedSquare = Square(move.endIndex.getFile(), move.startIndex.getRank());
+		togglePiece(capturedSquare, {PieceType::Pawn, otherColor});
 	}
-	if (move.isCastling){
-		Move castlingMove = Move(move.castlingStart, move.castlingEnd);
-		castlingMove.piece = {PieceType::Rook, move.piece.color};
+	else if (move.isCastling){
 		// apply the rook move to the bitboards
-		getPieceBitboardForOneColor(castlingMove.piece.color).applyMove(castlingMove);
-		currentState.allPieceBitboard.applyMove(castlingMove);
-		getBitboard(castlingMove.piece).applyMove(castlingMove);
-		currentState.zobristHash ^= zobristTable.at(castlingMove.startIndex.getIndex64()).at(castlingMove.piece.getRaw());
-		currentState.zobristHash ^= zobristTable.at(castlingMove.endIndex.getIndex64()).at(castlingMove.piece.getRaw());
+		const Piece rook = {PieceType::Rook, move.piece.color};
+		togglePiece(move.castlingStart, rook);
+		togglePiece(move.castlingEnd, rook);
 	}
-	if (move.isDoublePawnMove){
-		// get the "jumped" square
-		currentState.enPassantSquareForFEN = Coordinate(move.startIndex.x, (move.startIndex.y + move.endIndex.y) / 2);
-		currentState.enPassantSquareToCapture = move.endIndex;
-		currentState.hasEnPassant = true;
-	}
-	else{
-		currentState.hasEnPassant = false;
+
+	// get the "jumped" square
+	state().enPassantSquare = move.isDoublePawnMove ? Square((move.startIndex.getIndex64() + move.endIndex.getIndex64()) / 2) : Square();
+
+	if (attackTracking){
+		// captures and promotions change the piece on the end square without changing the occupancy
+		updateAttackTables((occupiedBefore ^ getAllPieceBitboard()) | Bitboard::fromIndex64(end));
 	}
 }
 
+template void Board::applyMove<MoveApplication::MakeUnmake>(Move const& move);
+template void Board::applyMove<MoveApplication::CopyMake>(Move const& move);
+
+template<MoveApplication application>
 void Board::rewindMove(){
-	if (rewindStack.empty())
+	if (application == MoveApplication::CopyMake ? plyStates.getPly() == 0 : rewindStack.empty())
 		throw std::runtime_error("Tried to rewind move, but no moves were made.");
 	
 	const int newCount = --numberOfPositionRepetitions.at(getCurrentHash());
@@ -288,43 +309,114 @@ void Board::rewindMove(){
 		numberOfPositionRepetitions.erase(getCurrentHash());
 	}
 
-	currentState = rewindStack.top();
-	rewindStack.pop();
+	if constexpr (application == MoveApplication::CopyMake){
+		plyStates.pop();
+	}
+	else{
+		state() = rewindStack.top();
+		rewindStack.pop();
+	}
+
+	if (attackTracking){
+		if (attackTablesRewindStack.empty()){
+			refreshAttackTables();
+		}
+		else{
+			attackTables = attackTablesRewindStack.top();
+			attackTablesRewindStack.pop();
+		}
+	}
+}
+
+template void Board::rewindMove<MoveApplication::MakeUnmake>();
+template void Board::rewindMove<MoveApplication::CopyMake>();
+
+void Board::setAttackTracking(bool enabled){
+	attackTracking = enabled;
+	// the tables of earlier moves are unknown, so rewinding past this point recomputes them
+	while (!attackTablesRewindStack.empty()) attackTablesRewindStack.pop();
+	if (enabled) refreshAttackTables();
 }
 
+void Board::refreshAttackTables(){
+	attackTables.attacksFrom.fill(Bitboard(0));
+	attackTables.attacksTo.fill(Bitboard(0));
+	Bitboard pieces = getAllPieceBitboard();
+	while (pieces.hasPieces()){
+		updateAttacksFrom(pieces.getLS1B());
+		pieces.clearLS1B();
+	}
+}
 
-void Board::placePiece(Coordinate square, Piece piece){
-	currentState.zobristHash ^= zobristTable.at(square.getIndex64()).at(piece.getRaw());
-	getBitboard(piece).placePiece(square);
-	currentState.allPieceBitboard.placePiece(square);
-	getPieceBitboardForOneColor(piece.color).placePiece(square);
+Bitboard Board::getAttackedSquares(PieceColor color) const{
+	Bitboard attacked;
+	Bitboard pieces = getPieceBitboardForOneColor(color);
+	while (pieces.hasPieces()){
+		attacked |= attackTables.attacksFrom[pieces.getLS1B()];
+		pieces.clearLS1B();
+	}
+	return attacked;
 }
 
-void Board::removePiece(Coordinate square){
-	currentState.zobristHash ^= zobristTable.at(square.getIndex64()).at(at(square).getRaw());
-	currentState.allPieceBitboard.removePiece(square);
-	for (auto& bb : currentState.pieceBitboards){
-		bb.removePiece(square);
+void Board::updateAttacksFrom(uint8_t square){
+	Bitboard attacks;
+	if (getAllPieceBitboard().isOccupied(square)){
+		const Piece piece = at(Square(square));
+		if (piece.type == PieceType::Pawn){
+			const int forward = piece.color == PieceColor::White ? DirectionIndex64::N : DirectionIndex64::S;
+			const Bitboard pawn = Bitboard::fromIndex64(square);
+			attacks = ((pawn & 0xfefefefefefefefe) << (forward + DirectionIndex64::W)) | ((pawn & 0x7f7f7f7f7f7f7f7f) << (forward + DirectionIndex64::E));
+		}
+		else{
+			attacks = MoveGenerator::getPieceAttacks(piece.type, Square(square), getAllPieceBitboard());
+		}
+	}
+
+	const Bitboard oldAttacks = attackTables.attacksFrom[square];
+	Bitboard removed = oldAttacks & ~attacks;
+	Bitboard added = attacks & ~oldAttacks;
+	while (removed.hasPieces()){
+		attackTables.attacksTo[removed.getLS1B()].clearBit(square);
+		removed.clearLS1B();
+	}
+	while (added.hasPieces()){
+		attackTables.attacksTo[added.getLS1B()].setBit(square);
+		added.clearLS1B();
 	}
+	attackTables.attacksFrom[square] = attacks;
 }
 
-void Board::removeCastlings(Coordinate movedSquare){
-	switch(movedSquare.getIndex64()){
-		// rook moves
-		case SquareIndex64::a8: currentState.canBlackCastleLeft = false; break;
-		case SquareIndex64::h8: currentState.canBlackCastleRight = false; break;
-		case SquareIndex64::a1: currentState.canWhiteCastleLeft = false; break;
-		case SquareIndex64::h1: currentState.canWhiteCastleRight = false; break;
-
-		// king moves
-		case SquareIndex64::e8:
-			currentState.canBlackCastleLeft = false;
-			currentState.canBlackCastleRight = false;
-			break;
-		case SquareIndex64::e1:
-			currentState.canWhiteCastleLeft = false;
-			currentState.canWhiteCastleRight = false;
-			break;
+void Board::updateAttackTables(Bitboard changedSquares){
+	const Bitboard sliders = getPieceTypeBitboard(PieceType::Bishop) | getPieceTypeBitboard(PieceType::Rook) | getPieceTypeBitboard(PieceType::Queen);
+
+	// every ray passing through or ending on a changed square contains it, so its slider is in the reverse table
+	Bitboard affected = changedSquares;
+	Bitboard changed = changedSquares;
+	while (changed.hasPieces()){
+		affected |= attackTables.attacksTo[changed.getLS1B()] & sliders;
+		changed.clearLS1B();
+	}
+
+	while (affected.hasPieces()){
+		updateAttacksFrom(affected.getLS1B());
+		affected.clearLS1B();
 	}
 }
+
+
+void Board::placePiece(Square square, Piece piece){
+	if (getAllPieceBitboard().isOccupied(square)) removePiece(square);
+	togglePiece(square, piece);
+}
+
+void Board::removePiece(Square square){
+	const Piece piece = at(square);
+	if (piece.type == PieceType::None) return;
+	togglePiece(square, piece);
+}
+
+void Board::removePiece(Square square, Piece piece){
+	togglePiece(square, piece);
+}
+
 }
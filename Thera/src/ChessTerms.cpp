@@ -14,10 +14,10 @@ Coordinate squareFromAlgebraicNotation(std::string const& str){
     return Coordinate(x, y);
 }
 
-std::string squareToAlgebraicNotation(Coordinate square){
-    if (!Utils::isInRange<uint8_t>(square.x, 0, 7) || !Utils::isInRange<uint8_t>(square.y, 0, 7)) throw std::invalid_argument(std::to_string(square.x) + ";" + std::to_string(square.y) + " isn't a valid square");
+std::string squareToAlgebraicNotation(Square square){
+    if (square.getIndex64() >= 64) throw std::invalid_argument(std::to_string(square.getIndex64()) + " isn't a valid square");
 
-    return std::string(1, 'a' + square.x) + std::string(1, square.y + '1');
+    return std::string(1, 'a' + square.getFile()) + std::string(1, square.getRank() + '1');
 }
 
 std::string pieceColorToString(PieceColor color){
@@ -0,0 +1,214 @@
+#include "Thera/ClusterNode.hpp"
+
+#include <stdexcept>
+#include <filesystem>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+namespace Thera{
+
+struct MessageHeader{
+    enum class Type : uint32_t{
+        Entries,
+        RootResults,
+    };
+
+    static constexpr uint32_t expectedMagic = 0x54434C53; // "TCLS"
+
+    uint32_t magic = expectedMagic;
+    Type type;
+    uint32_t count;
+};
+
+// keeps datagrams well below the default socket buffer size
+static constexpr size_t maxItemsPerMessage = 1024;
+
+template<typename T>
+static std::vector<char> createMessage(MessageHeader::Type type, T const* items, size_t count){
+    MessageHeader header;
+    header.type = type;
+    header.count = count;
+
+    std::vector<char> message(sizeof(header) + count * sizeof(T));
+    std::memcpy(message.data(), &header, sizeof(header));
+    std::memcpy(message.data() + sizeof(header), items, count * sizeof(T));
+    return message;
+}
+
+static sockaddr_un getSocketAddress(std::string const& path){
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) throw std::runtime_error("Cluster socket path is too long: " + path);
+    std::strcpy(address.sun_path, path.c_str());
+    return address;
+}
+
+ClusterNode::ClusterNode(TranspositionTable& transpositionTable): transpositionTable(transpositionTable){
+}
+
+ClusterNode::~ClusterNode(){
+    close();
+}
+
+void ClusterNode::open(std::string const& directory, int minSharedDepth){
+    close();
+
+    std::filesystem::create_directories(directory);
+    this->directory = directory;
+    socketPath = (std::filesystem::path(directory) / (std::to_string(getpid()) + ".sock")).string();
+
+    socketFD = socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (socketFD == -1) throw std::runtime_error(std::string("Unable to create cluster socket: ") + strerror(errno));
+
+    // a previous process with the same pid can't be running anymore
+    unlink(socketPath.c_str());
+    const sockaddr_un address = getSocketAddress(socketPath);
+    if (bind(socketFD, reinterpret_cast<sockaddr const*>(&address), sizeof(address)) != 0){
+        const std::string error = strerror(errno);
+        ::close(socketFD);
+        socketFD = -1;
+        throw std::runtime_error("Unable to bind cluster socket \"" + socketPath + "\": " + error);
+    }
+
+    rootResults.clear();
+    transpositionTable.setDeepEntryListener(minSharedDepth, [this](uint64_t key, TranspositionTable::Entry::Data data){
+        outgoingEntries.tryPush({key, data});
+    });
+
+    communicationThreadShouldExit = false;
+    communicationThread = std::thread(&ClusterNode::communicationThreadFunction, this);
+}
+
+void ClusterNode::close(){
+    if (!isOpen()) return;
+
+    transpositionTable.setDeepEntryListener(0, {});
+
+    communicationThreadShouldExit = true;
+    communicationThread.join();
+
+    ::close(socketFD);
+    socketFD = -1;
+    unlink(socketPath.c_str());
+
+    SharedEntry entry;
+    while (outgoingEntries.tryPop(entry));
+    outgoingRootResults.clear();
+}
+
+void ClusterNode::publishRootResult(RootResult const& result){
+    addRootResult(result);
+
+    std::lock_guard lock(outgoingMutex);
+    outgoingRootResults.push_back(result);
+}
+
+std::optional<ClusterNode::RootResult> ClusterNode::getDeepestRootResult(uint64_t key){
+    std::lock_guard lock(rootResultsMutex);
+    const auto it = rootResults.find(key);
+    if (it == rootResults.end()) return {};
+    return it->second;
+}
+
+void ClusterNode::addRootResult(RootResult const& result){
+    std::lock_guard lock(rootResultsMutex);
+    auto [it, isNew] = rootResults.emplace(result.key, result);
+    if (!isNew && it->second.depth < result.depth){
+        it->second = result;
+    }
+}
+
+void ClusterNode::communicationThreadFunction(){
+    std::vector<SharedEntry> entries;
+    std::vector<RootResult> results;
+
+    while (!communicationThreadShouldExit){
+        // wait for incoming messages until the next exchange is due
+        const auto nextExchange = std::chrono::steady_clock::now() + exchangeInterval;
+        while (true){
+            const int timeoutMS = std::chrono::ceil<std::chrono::milliseconds>(nextExchange - std::chrono::steady_clock::now()).count();
+            if (timeoutMS <= 0) break;
+
+            pollfd pollFD{socketFD, POLLIN, 0};
+            if (poll(&pollFD, 1, timeoutMS) > 0) receiveMessages();
+        }
+
+        SharedEntry entry;
+        while (outgoingEntries.tryPop(entry)){
+            entries.push_back(entry);
+        }
+        {
+            std::lock_guard lock(outgoingMutex);
+            std::swap(results, outgoingRootResults);
+        }
+
+        for (size_t i=0; i<entries.size(); i += maxItemsPerMessage){
+            sendToPeers(createMessage(MessageHeader::Type::Entries, entries.data() + i, std::min(maxItemsPerMessage, entries.size() - i)));
+        }
+        for (size_t i=0; i<results.size(); i += maxItemsPerMessage){
+            sendToPeers(createMessage(MessageHeader::Type::RootResults, results.data() + i, std::min(maxItemsPerMessage, results.size() - i)));
+        }
+        entries.clear();
+        results.clear();
+    }
+}
+
+void ClusterNode::sendToPeers(std::vector<char> const& message){
+    std::error_code error;
+    for (auto const& file : std::filesystem::directory_iterator(directory, error)){
+        const std::string path = file.path().string();
+        if (file.path().extension() != ".sock" || path == socketPath) continue;
+
+        sockaddr_un address;
+        try{
+            address = getSocketAddress(path);
+        }
+        catch(std::runtime_error const&){
+            continue;
+        }
+
+        // peers with full buffers simply miss this message
+        if (sendto(socketFD, message.data(), message.size(), MSG_DONTWAIT, reinterpret_cast<sockaddr const*>(&address), sizeof(address)) == -1 && errno == ECONNREFUSED){
+            // nobody is listening anymore, so the peer must have crashed
+            unlink(path.c_str());
+        }
+    }
+}
+
+void ClusterNode::receiveMessages(){
+    static thread_local std::vector<char> buffer(sizeof(MessageHeader) + maxItemsPerMessage * std::max(sizeof(SharedEntry), sizeof(RootResult)));
+
+    while (true){
+        const ssize_t size = recv(socketFD, buffer.data(), buffer.size(), MSG_DONTWAIT);
+        if (size < ssize_t(sizeof(MessageHeader))) return;
+
+        MessageHeader header;
+        std::memcpy(&header, buffer.data(), sizeof(header));
+        if (header.magic != MessageHeader::expectedMagic) continue;
+        const char* payload = buffer.data() + sizeof(header);
+
+        if (header.type == MessageHeader::Type::Entries && size_t(size) == sizeof(header) + header.count * sizeof(SharedEntry)){
+            for (uint32_t i=0; i<header.count; i++){
+                SharedEntry entry;
+                std::memcpy(&entry, payload + i * sizeof(SharedEntry), sizeof(entry));
+                transpositionTable.storeEntry(entry.key, entry.data);
+            }
+            numReceivedEntries += header.count;
+        }
+        else if (header.type == MessageHeader::Type::RootResults && size_t(size) == sizeof(header) + header.count * sizeof(RootResult)){
+            for (uint32_t i=0; i<header.count; i++){
+                RootResult result;
+                std::memcpy(&result, payload + i * sizeof(RootResult), sizeof(result));
+                addRootResult(result);
+            }
+        }
+    }
+}
+
+}
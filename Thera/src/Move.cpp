@@ -1,7 +1,12 @@
 #include "Thera/Move.hpp"
+#include "Thera/Board.hpp"
+#include "Thera/MoveGenerator.hpp"
 #include "Thera/Utils/ChessTerms.hpp"
+#include "Thera/Utils/ScopeGuard.hpp"
 
 #include <stdexcept>
+#include <optional>
+#include <cstdlib>
 
 namespace Thera{
 
@@ -40,4 +45,304 @@ std::string Move::toString() const{
     return result;
 }
 
-}
\ No newline at end of file
+uint16_t Move::encode() const{
+    const Square end = isCastling ? castlingStart : endIndex;
+
+    uint16_t promotion = 0;
+    switch (promotionType){
+        case PieceType::Knight: promotion = 1; break;
+        case PieceType::Bishop: promotion = 2; break;
+        case PieceType::Rook:   promotion = 3; break;
+        case PieceType::Queen:  promotion = 4; break;
+        default: break;
+    }
+
+    return end.getIndex64() | (startIndex.getIndex64() << 6) | (promotion << 12);
+}
+
+Move Move::decode(uint16_t encoded){
+    Move move(
+        Square((encoded >> 6) & 63),
+        Square(encoded & 63)
+    );
+    switch ((encoded >> 12) & 7){
+        case 1: move.promotionType = PieceType::Knight; break;
+        case 2: move.promotionType = PieceType::Bishop; break;
+        case 3: move.promotionType = PieceType::Rook; break;
+        case 4: move.promotionType = PieceType::Queen; break;
+        default: break;
+    }
+    return move;
+}
+
+static char pieceTypeToSANLetter(PieceType type){
+    switch (type){
+        case PieceType::Knight: return 'N';
+        case PieceType::Bishop: return 'B';
+        case PieceType::Rook:   return 'R';
+        case PieceType::Queen:  return 'Q';
+        case PieceType::King:   return 'K';
+        default:                return '?';
+    }
+}
+
+static PieceType pieceTypeFromSANLetter(char c){
+    switch (c){
+        case 'N': return PieceType::Knight;
+        case 'B': return PieceType::Bishop;
+        case 'R': return PieceType::Rook;
+        case 'Q': return PieceType::Queen;
+        case 'K': return PieceType::King;
+        default:  return PieceType::None;
+    }
+}
+
+/**
+ * @brief Check whether a move (other than castling) of the side to move leaves its own king attacked.
+ * 
+ * The attackers of the king square are looked up with the pieces already moved,
+ * which covers pins, moves that don't resolve a check and king moves to attacked squares.
+ * 
+ * @param board the position to operate on
+ * @param start the start square of the moving piece
+ * @param end the target square
+ * @param isEnPassant whether the move is an en passant capture
+ * @return bool true if the move is illegal
+ */
+static bool leavesKingAttacked(Board const& board, Square start, Square end, bool isEnPassant){
+    const Bitboard captured = Bitboard::fromIndex64(isEnPassant ? Square(end.getFile(), start.getRank()).getIndex64() : end.getIndex64());
+    const Bitboard occupied = (board.getAllPieceBitboard() & ~captured & ~Bitboard::fromIndex64(start.getIndex64())) | Bitboard::fromIndex64(end.getIndex64());
+
+    const Bitboard king = board.getBitboard({PieceType::King, board.getColorToMove()});
+    const Square kingSquare = king.isOccupied(start) ? end : Square(king.getLS1B());
+    const Bitboard enemyPieces = board.getPieceBitboardForOneColor(board.getColorToNotMove()) & ~captured;
+    return (MoveGenerator::getAttackersTo(board, kingSquare, occupied) & enemyPieces).hasPieces();
+}
+
+/**
+ * @brief Remove all pieces from candidates that can't legally move to target.
+ * 
+ * @param candidates pieces that attack the target square
+ * @param target the square to move to
+ * @param board the position to operate on
+ * @return Bitboard the candidates that can legally move to target
+ */
+static Bitboard removeIllegalCandidates(Bitboard candidates, Square target, Board const& board){
+    Bitboard remaining = candidates;
+    while (remaining.hasPieces()){
+        const uint8_t square = remaining.getLS1B();
+        if (leavesKingAttacked(board, Square(square), target, false))
+            candidates.clearBit(square);
+        remaining.clearLS1B();
+    }
+    return candidates;
+}
+
+/**
+ * @brief Check whether a castling move is legal, assuming the castling right exists.
+ * 
+ * The squares between king and rook have to be empty, and the king may not start on,
+ * pass or land on an attacked square.
+ * 
+ * @param board the position to operate on
+ * @param move the castling move
+ * @return bool true if the move is legal
+ */
+static bool isCastlingLegal(Board const& board, Move const& move){
+    const Bitboard occupied = board.getAllPieceBitboard();
+    if ((MoveGenerator::obstructedLUT.at(move.startIndex.getIndex64()).at(move.castlingStart.getIndex64()) & occupied).hasPieces())
+        return false;
+
+    const Bitboard enemyPieces = board.getPieceBitboardForOneColor(board.getColorToNotMove());
+    for (Square square : {move.startIndex, move.castlingEnd, move.endIndex}){
+        if ((MoveGenerator::getAttackersTo(board, square, occupied) & enemyPieces).hasPieces())
+            return false;
+    }
+    return true;
+}
+
+static Move createCastlingMove(Board const& board, bool kingSide){
+    const Piece king = {PieceType::King, board.getColorToMove()};
+    const Square square = Square(board.getBitboard(king).getLS1B());
+    const auto& state = board.getCurrentState();
+    const bool isAllowed = board.getColorToMove() == PieceColor::White
+        ? (kingSide ? state.canWhiteCastleRight() : state.canWhiteCastleLeft())
+        : (kingSide ? state.canBlackCastleRight() : state.canBlackCastleLeft());
+    if (!isAllowed) throw std::invalid_argument("Castling isn't allowed in this position");
+
+    Move move(square, square + (kingSide ? DirectionIndex64::E : DirectionIndex64::W)*2, king);
+    move.isCastling = true;
+    move.castlingStart = square + (kingSide ? DirectionIndex64::E*3 : DirectionIndex64::W*4);
+    move.castlingEnd = square + (kingSide ? DirectionIndex64::E : DirectionIndex64::W);
+    return move;
+}
+
+/**
+ * @brief Find the move described by a SAN string, without checking whether it is legal.
+ * 
+ * @param str the string to parse from
+ * @param board the position the move is played in
+ * @return Move the move of the described piece
+ */
+static Move parseSAN(std::string const& str, Board const& board){
+    std::string san = str;
+    while (san.size() && std::string("+#!?").find(san.back()) != std::string::npos)
+        san.pop_back();
+
+    if (san == "O-O" || san == "0-0") return createCastlingMove(board, true);
+    if (san == "O-O-O" || san == "0-0-0") return createCastlingMove(board, false);
+
+    const auto invalid = [&](std::string const& reason){
+        return std::invalid_argument("\"" + str + "\" isn't a valid SAN move (" + reason + ")");
+    };
+    if (san.size() < 2) throw invalid("too short");
+
+    const PieceColor color = board.getColorToMove();
+    Move move;
+    move.piece = {pieceTypeFromSANLetter(san.front()), color};
+    if (move.piece.type == PieceType::None)
+        move.piece.type = PieceType::Pawn;
+    else
+        san.erase(0, 1);
+
+    // promotion ("e8=Q" or "e8Q")
+    if (san.size() >= 3 && pieceTypeFromSANLetter(san.back()) != PieceType::None){
+        move.promotionType = pieceTypeFromSANLetter(san.back());
+        san.pop_back();
+        if (san.back() == '=') san.pop_back();
+    }
+
+    if (san.size() < 2) throw invalid("missing target square");
+    move.endIndex = Utils::squareFromAlgebraicNotation(san.substr(san.size()-2));
+    san.erase(san.size()-2);
+
+    bool isCapture = false;
+    if (san.size() && san.back() == 'x'){
+        isCapture = true;
+        san.pop_back();
+    }
+
+    std::optional<uint8_t> fromFile, fromRank;
+    for (char c : san){
+        if (Utils::isInRange(c, 'a', 'h')) fromFile = c - 'a';
+        else if (Utils::isInRange(c, '1', '8')) fromRank = c - '1';
+        else throw invalid("unexpected character");
+    }
+
+    if (board.getPieceBitboardForOneColor(color).isOccupied(move.endIndex))
+        throw invalid("target square is occupied by an own piece");
+    const bool isEnPassant = move.piece.type == PieceType::Pawn && board.hasEnPassant() && move.endIndex == board.getEnPassantSquareForFEN();
+    if (isCapture && !isEnPassant && !board.getPieceBitboardForOneColor(board.getColorToNotMove()).isOccupied(move.endIndex))
+        throw invalid("nothing to capture");
+
+    const Bitboard ownPieces = board.getBitboard(move.piece);
+
+    if (move.piece.type == PieceType::Pawn){
+        const int forward = color == PieceColor::White ? 1 : -1;
+        const uint8_t promotionRank = color == PieceColor::White ? 7 : 0;
+        if ((move.endIndex.getRank() == promotionRank) != (move.promotionType != PieceType::None))
+            throw invalid("invalid promotion");
+        if (!Utils::isInRange(int(move.endIndex.getRank()) - forward, 0, 7))
+            throw invalid("no pawn can make this move");
+
+        if (isCapture || fromFile.has_value()){
+            if (!fromFile.has_value()) throw invalid("missing file of capturing pawn");
+            if (std::abs(int(fromFile.value()) - int(move.endIndex.getFile())) != 1) throw invalid("pawns capture on an adjacent file");
+            if (!isEnPassant && !board.getPieceBitboardForOneColor(board.getColorToNotMove()).isOccupied(move.endIndex))
+                throw invalid("nothing to capture");
+            move.startIndex = Square(fromFile.value(), move.endIndex.getRank() - forward);
+            move.isEnPassant = isEnPassant;
+        }
+        else{
+            if (board.getAllPieceBitboard().isOccupied(move.endIndex)) throw invalid("pawns only capture diagonally");
+            move.startIndex = move.endIndex - DirectionIndex64::N*forward;
+            const uint8_t doublePushRank = color == PieceColor::White ? 3 : 4;
+            if (!ownPieces.isOccupied(move.startIndex) && move.endIndex.getRank() == doublePushRank && !board.getAllPieceBitboard().isOccupied(move.startIndex)){
+                move.startIndex = move.endIndex - DirectionIndex64::N*2*forward;
+                move.isDoublePawnMove = true;
+            }
+        }
+        if (!ownPieces.isOccupied(move.startIndex)) throw invalid("no pawn can make this move");
+        return move;
+    }
+
+    if (move.promotionType != PieceType::None) throw invalid("only pawns can promote");
+
+    Bitboard candidates = MoveGenerator::getPieceAttacks(move.piece.type, move.endIndex, board.getAllPieceBitboard()) & ownPieces;
+    if (fromFile.has_value()) candidates &= Bitboard(0x0101010101010101) << fromFile.value();
+    if (fromRank.has_value()) candidates &= Bitboard(0xFF) << (fromRank.value()*8);
+    if (candidates.getNumPieces() > 1)
+        candidates = removeIllegalCandidates(candidates, move.endIndex, board);
+
+    if (!candidates.hasPieces()) throw invalid("no piece can make this move");
+    if (candidates.getNumPieces() > 1) throw invalid("ambiguous move");
+
+    move.startIndex = Square(candidates.getLS1B());
+    return move;
+}
+
+Move Move::fromSAN(std::string const& str, Board const& board){
+    const Move move = parseSAN(str, board);
+
+    const bool isLegal = move.isCastling ? isCastlingLegal(board, move) : !leavesKingAttacked(board, move.startIndex, move.endIndex, move.isEnPassant);
+    if (!isLegal) throw std::invalid_argument("\"" + str + "\" isn't a legal move in this position");
+    return move;
+}
+
+std::string Move::toSAN(Board& board, MoveGenerator& generator) const{
+    std::string result;
+    const bool isCapture = isEnPassant || board.getPieceBitboardForOneColor(board.getColorToNotMove()).isOccupied(endIndex);
+
+    if (isCastling){
+        result = endIndex.getFile() > startIndex.getFile() ? "O-O" : "O-O-O";
+    }
+    else if (piece.type == PieceType::Pawn){
+        if (isCapture){
+            result += static_cast<char>('a' + startIndex.getFile());
+            result += 'x';
+        }
+        result += Utils::squareToAlgebraicNotation(endIndex);
+        if (promotionType != PieceType::None){
+            result += '=';
+            result += pieceTypeToSANLetter(promotionType);
+        }
+    }
+    else{
+        result += pieceTypeToSANLetter(piece.type);
+
+        // other pieces of the same type that could also move to the target
+        Bitboard others = MoveGenerator::getPieceAttacks(piece.type, endIndex, board.getAllPieceBitboard()) & board.getBitboard(piece);
+        others.clearBit(startIndex.getIndex64());
+        if (others.hasPieces())
+            others = removeIllegalCandidates(others, endIndex, board);
+
+        if (others.hasPieces()){
+            const Bitboard sameFile = Bitboard(0x0101010101010101) << startIndex.getFile();
+            const Bitboard sameRank = Bitboard(0xFF) << (startIndex.getRank()*8);
+            if (!(others & sameFile).hasPieces()){
+                result += static_cast<char>('a' + startIndex.getFile());
+            }
+            else if (!(others & sameRank).hasPieces()){
+                result += static_cast<char>('1' + startIndex.getRank());
+            }
+            else{
+                result += Utils::squareToAlgebraicNotation(startIndex);
+            }
+        }
+
+        if (isCapture) result += 'x';
+        result += Utils::squareToAlgebraicNotation(endIndex);
+    }
+
+    board.applyMove(*this);
+    Utils::ScopeGuard moveRewind_guard([&](){board.rewindMove();});
+
+    generator.generateAttackData(board);
+    if (generator.isInCheck(board)){
+        result += generator.generateAllMoves(board).size() ? '+' : '#';
+    }
+
+    return result;
+}
+
+}
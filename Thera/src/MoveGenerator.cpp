@@ -5,6 +5,10 @@
 
 #include <tuple>
 
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#endif
+
 namespace Thera{
 
 std::vector<Move> MoveGenerator::generateAllMoves(Board const& board){
@@ -69,200 +73,219 @@ Bitboard slidingAttacks (Bitboard sliders, Bitboard empty, int dir8){
 //    return             (flood << r)   & MoveGenerator::slidingPieceAvoidWrapping[dir8];
 // }
 
+#if defined(__AVX2__)
+// Kogge-Stone for four directions at once, one direction per 64 bit lane.
+// Rotations by a different amount per lane are built from the variable shifts.
+static inline __m256i rotateLanesLeft(__m256i bits, __m256i amount, __m256i inverseAmount){
+    return _mm256_or_si256(_mm256_sllv_epi64(bits, amount), _mm256_srlv_epi64(bits, inverseAmount));
+}
+
+template <int firstDirectionIndex>
+Bitboard fourDirectionSlidingAttacks(Bitboard sliders, Bitboard empty){
+    static_assert(firstDirectionIndex % 4 == 0 && firstDirectionIndex + 4 <= 8, "Only the rook or bishop directions can be combined");
+    constexpr auto shifts = [](int factor){
+        std::array<long long, 4> result;
+        for (int i=0; i<4; i++)
+            result[i] = (MoveGenerator::slidingPieceShiftAmounts[firstDirectionIndex+i] * factor) & 63;
+        return result;
+    };
+    constexpr auto r1 = shifts(1), r2 = shifts(2), r4 = shifts(4);
+    const auto load = [](std::array<long long, 4> const& values){ return _mm256_setr_epi64x(values[0], values[1], values[2], values[3]); };
+    const __m256i sixtyFour = _mm256_set1_epi64x(64);
+    const __m256i shift1 = load(r1), shift2 = load(r2), shift4 = load(r4);
+    const __m256i inverseShift1 = _mm256_sub_epi64(sixtyFour, shift1);
+    const __m256i inverseShift2 = _mm256_sub_epi64(sixtyFour, shift2);
+    const __m256i inverseShift4 = _mm256_sub_epi64(sixtyFour, shift4);
+    const __m256i avoidWrapping = _mm256_setr_epi64x(
+        uint64_t(MoveGenerator::slidingPieceAvoidWrapping[firstDirectionIndex+0]),
+        uint64_t(MoveGenerator::slidingPieceAvoidWrapping[firstDirectionIndex+1]),
+        uint64_t(MoveGenerator::slidingPieceAvoidWrapping[firstDirectionIndex+2]),
+        uint64_t(MoveGenerator::slidingPieceAvoidWrapping[firstDirectionIndex+3])
+    );
+
+    __m256i gen = _mm256_set1_epi64x(uint64_t(sliders));
+    __m256i pro = _mm256_and_si256(_mm256_set1_epi64x(uint64_t(empty)), avoidWrapping);
+    gen = _mm256_or_si256(gen, _mm256_and_si256(pro, rotateLanesLeft(gen, shift1, inverseShift1)));
+    pro = _mm256_and_si256(pro, rotateLanesLeft(pro, shift1, inverseShift1));
+    gen = _mm256_or_si256(gen, _mm256_and_si256(pro, rotateLanesLeft(gen, shift2, inverseShift2)));
+    pro = _mm256_and_si256(pro, rotateLanesLeft(pro, shift2, inverseShift2));
+    gen = _mm256_or_si256(gen, _mm256_and_si256(pro, rotateLanesLeft(gen, shift4, inverseShift4)));
+
+    // shift one step further and combine the lanes
+    const __m256i attacks = _mm256_and_si256(rotateLanesLeft(gen, shift1, inverseShift1), avoidWrapping);
+    const __m128i half = _mm_or_si128(_mm256_castsi256_si128(attacks), _mm256_extracti128_si256(attacks, 1));
+    return uint64_t(_mm_cvtsi128_si64(half)) | uint64_t(_mm_extract_epi64(half, 1));
+}
+#endif
+
+// works for whole sets of sliders at once, since a ray never returns to its own origin
 template <int startDirectionIndex, int endDirectionIndex>
 Bitboard allDirectionSlidingAttacks(Bitboard occupied, Bitboard square){
     static_assert(startDirectionIndex < endDirectionIndex, "Infinite loop prevented");
     Bitboard targetSquares;
 
+#if defined(__AVX2__)
+    if constexpr (startDirectionIndex % 4 == 0 && endDirectionIndex % 4 == 0){
+        targetSquares |= fourDirectionSlidingAttacks<startDirectionIndex>(square, ~occupied);
+        if constexpr (endDirectionIndex - startDirectionIndex == 8)
+            targetSquares |= fourDirectionSlidingAttacks<startDirectionIndex+4>(square, ~occupied);
+        return targetSquares;
+    }
+#endif
+
     for (int directionIdx = startDirectionIndex; directionIdx < endDirectionIndex; directionIdx++){
         targetSquares |= slidingAttacks(square, ~occupied, directionIdx);
     }
-    targetSquares &= ~square;
 
     return targetSquares;
 }
 
-template <int startDirectionIndex, int endDirectionIndex>
-Bitboard xRayAttacks(Bitboard occupiedSquares, Bitboard blockers, Bitboard square) {
-   Bitboard attacks = allDirectionSlidingAttacks<startDirectionIndex, endDirectionIndex>(occupiedSquares, square);
-   blockers &= attacks;
-   return attacks ^ allDirectionSlidingAttacks<startDirectionIndex, endDirectionIndex>(occupiedSquares ^ blockers, square);
-}
-
 bool MoveGenerator::isInCheck(Board const& board) const{
     return (attackedSquares & board.getBitboard({PieceType::King, board.getColorToMove()})).hasPieces();
 }
 
+Bitboard MoveGenerator::getPieceAttacks(PieceType type, Square square, Bitboard occupied){
+    const Bitboard squareBB = Bitboard::fromIndex64(square.getIndex64());
+    switch (type){
+        case PieceType::Knight: return knightSquaresValid.at(square.getIndex64());
+        case PieceType::King:   return kingSquaresValid.at(square.getIndex64());
+        case PieceType::Bishop: return allDirectionSlidingAttacks<4, 8>(occupied, squareBB);
+        case PieceType::Rook:   return allDirectionSlidingAttacks<0, 4>(occupied, squareBB);
+        case PieceType::Queen:  return allDirectionSlidingAttacks<0, 8>(occupied, squareBB);
+        default:
+            throw std::invalid_argument("Attacks can't be generated for " + Utils::pieceTypeToString(type, true));
+    }
+}
+
 void MoveGenerator::generatePins(Board const& board) {
-    const auto squareOfKing = board.getBitboard({PieceType::King, board.getColorToMove()});
-    const uint8_t squareOfKingIndex = squareOfKing.getLS1B();
+    const uint8_t kingSquare = board.getBitboard({PieceType::King, board.getColorToMove()}).getLS1B();
 
     const auto oppositeQueens = board.getBitboard({PieceType::Queen, board.getColorToNotMove()});
     const auto oppositeRooks = board.getBitboard({PieceType::Rook, board.getColorToNotMove()}) | oppositeQueens;
     const auto oppositeBishops = board.getBitboard({PieceType::Bishop, board.getColorToNotMove()}) | oppositeQueens;
     const auto occupiedSquares = board.getAllPieceBitboard();
-    const auto ownPieces = board.getAllPieceBitboard();
-
-    const auto helper = [&]<int idx>(Bitboard oppositePieces){
-        static_assert(idx >= 0 && idx < 8, "Index has to be between 0 and 7");
-        Bitboard pinner = xRayAttacks<idx, idx+1>(occupiedSquares, ownPieces, squareOfKing) & oppositePieces;
-        if (pinner.hasPieces()) {
-            Bitboard result = MoveGenerator::obstructedLUT.at(pinner.getLS1B()).at(squareOfKingIndex) & ownPieces;
-            pinnedPieces |= result;
-            switch(idx){
-                case 0: pinDirection.at(result.getLS1B()) = {0, 3}; break;
-                case 1: pinDirection.at(result.getLS1B()) = {1, 2}; break;
-                case 2: pinDirection.at(result.getLS1B()) = {2, 1}; break;
-                case 3: pinDirection.at(result.getLS1B()) = {3, 0}; break;
-                case 4: pinDirection.at(result.getLS1B()) = {4, 7}; break;
-                case 5: pinDirection.at(result.getLS1B()) = {5, 6}; break;
-                case 6: pinDirection.at(result.getLS1B()) = {6, 5}; break;
-                case 7: pinDirection.at(result.getLS1B()) = {7, 4}; break;
-            }
-        }
-    };
+    const auto ownPieces = board.getPieceBitboardForOneColor(board.getColorToMove());
+
+    // sliders that would attack the king on an empty board either give check, pin exactly one own piece or are blocked
+    Bitboard candidates = (rookRaysLUT.at(kingSquare) & oppositeRooks) | (bishopRaysLUT.at(kingSquare) & oppositeBishops);
 
-    pinDirection.fill({0,0});
     pinnedPieces = 0;
+    sliderCheckers = 0;
     possibleTargets = 0;
-    // stupid syntax but helper<0>(oppositeRooks) could mean that the variable "helper" is templated, instead of the lambda
-    helper.operator()<0>(oppositeRooks);
-    helper.operator()<1>(oppositeRooks);
-    helper.operator()<2>(oppositeRooks);
-    helper.operator()<3>(oppositeRooks);
-
-    helper.operator()<4>(oppositeBishops);
-    helper.operator()<5>(oppositeBishops);
-    helper.operator()<6>(oppositeBishops);
-    helper.operator()<7>(oppositeBishops);
-}
-
-void MoveGenerator::generateAttackData(Board const& board){
-    attackedSquares = 0;
-    squaresAttackedBySquare.fill(Bitboard(0));
-    squaresAttackingSquare.fill(Bitboard(0));
-    generatePins(board);
-
-    // sliding pieces
-    // rook and queen
-    Bitboard oppositeSlidingPiecesAndPawns;
-    const Bitboard slidingBlockers = board.getAllPieceBitboard() ^ board.getBitboard({PieceType::King, board.getColorToMove()});
-
-    Bitboard bitboard = board.getBitboard({PieceType::Rook, board.getColorToNotMove()}) | board.getBitboard({PieceType::Queen, board.getColorToNotMove()});
-    oppositeSlidingPiecesAndPawns |= bitboard;
-
-    while (bitboard.hasPieces()){
-        auto const origin_square = bitboard.getLS1B();
-        Bitboard targetSquares = allDirectionSlidingAttacks<0, 4>(slidingBlockers, Bitboard::fromIndex64(origin_square));
-
-        attackedSquares |= targetSquares;
-        squaresAttackedBySquare[origin_square] |= targetSquares;
-        while (targetSquares.hasPieces()){
-            squaresAttackingSquare.at(targetSquares.getLS1B()).setBit(origin_square);
-
-            targetSquares.clearLS1B();
+    while (candidates.hasPieces()){
+        const uint8_t candidate = candidates.getLS1B();
+        const Bitboard between = obstructedLUT[candidate][kingSquare] & occupiedSquares;
+        if (!between.hasPieces()){
+            sliderCheckers.setBit(candidate);
         }
-
-        bitboard.clearLS1B();
+        else if (between.getNumPieces() == 1 && (between & ownPieces).hasPieces()){
+            pinnedPieces |= between;
+            pinLines[between.getLS1B()] = lineLUT[candidate][kingSquare];
+        }
+        candidates.clearLS1B();
     }
+}
 
-    // bishop and queen
-    bitboard = board.getBitboard({PieceType::Bishop, board.getColorToNotMove()}) | board.getBitboard({PieceType::Queen, board.getColorToNotMove()});
-    oppositeSlidingPiecesAndPawns |= bitboard;
 
-    while (bitboard.hasPieces()){
-        auto const origin_square = bitboard.getLS1B();
-        Bitboard targetSquares = allDirectionSlidingAttacks<4, 8>(slidingBlockers, Bitboard::fromIndex64(origin_square));
-
-        attackedSquares |= targetSquares;
-        squaresAttackedBySquare[origin_square] |= targetSquares;
-        while (targetSquares.hasPieces()){
-            squaresAttackingSquare.at(targetSquares.getLS1B()).setBit(origin_square);
+// set-wise attacks of all knights in the bitboard
+static Bitboard knightAttacks(Bitboard knights){
+    const Bitboard oneFile = ((knights >> 1) & 0x7f7f7f7f7f7f7f7f) | ((knights << 1) & 0xfefefefefefefefe);
+    const Bitboard twoFiles = ((knights >> 2) & 0x3f3f3f3f3f3f3f3f) | ((knights << 2) & 0xfcfcfcfcfcfcfcfc);
+    return (oneFile << 16) | (oneFile >> 16) | (twoFiles << 8) | (twoFiles >> 8);
+}
 
-            targetSquares.clearLS1B();
-        }
+// set-wise attacks of all pawns of one color in the bitboard
+static Bitboard pawnAttacks(Bitboard pawns, PieceColor color){
+    const int mainDirection = color == PieceColor::White ? DirectionIndex64::N : DirectionIndex64::S;
+    return ((pawns & 0xfefefefefefefefe) << (mainDirection + DirectionIndex64::W)) |
+           ((pawns & 0x7f7f7f7f7f7f7f7f) << (mainDirection + DirectionIndex64::E));
+}
 
-        bitboard.clearLS1B();
+Bitboard MoveGenerator::getAttacks(Board const& board, PieceColor color, Bitboard occupied){
+    const Bitboard queens = board.getBitboard({PieceType::Queen, color});
+    const Bitboard king = board.getBitboard({PieceType::King, color});
+    if constexpr (Utils::BuildType::Current == Utils::BuildType::Debug){
+        if (!king.hasPieces()) throw std::runtime_error("No king for the attacking color found.");
     }
 
+    // all pieces of a type are handled at once
+    Bitboard attacks = allDirectionSlidingAttacks<0, 4>(occupied, board.getBitboard({PieceType::Rook, color}) | queens);
+    attacks |= allDirectionSlidingAttacks<4, 8>(occupied, board.getBitboard({PieceType::Bishop, color}) | queens);
+    attacks |= knightAttacks(board.getBitboard({PieceType::Knight, color}));
+    attacks |= kingSquaresValid.at(king.getLS1B());
+    attacks |= pawnAttacks(board.getBitboard({PieceType::Pawn, color}), color);
+    return attacks;
+}
 
-    // knight moves
-    bitboard = board.getBitboard({PieceType::Knight, board.getColorToNotMove()});
+Bitboard MoveGenerator::getCheckers(Board const& board){
+    const PieceColor otherColor = board.getColorToNotMove();
+    const Bitboard kingBB = board.getBitboard({PieceType::King, board.getColorToMove()});
+    const uint8_t kingSquare = kingBB.getLS1B();
+    const Bitboard queens = board.getBitboard({PieceType::Queen, otherColor});
+
+    Bitboard checkers = (knightSquaresValid.at(kingSquare) & board.getBitboard({PieceType::Knight, otherColor}))
+                      | (pawnAttacks(kingBB, board.getColorToMove()) & board.getBitboard({PieceType::Pawn, otherColor}));
+
+    Bitboard sliders = (rookRaysLUT.at(kingSquare) & (board.getBitboard({PieceType::Rook, otherColor}) | queens))
+                     | (bishopRaysLUT.at(kingSquare) & (board.getBitboard({PieceType::Bishop, otherColor}) | queens));
+    while (sliders.hasPieces()){
+        if (!(obstructedLUT[sliders.getLS1B()][kingSquare] & board.getAllPieceBitboard()).hasPieces())
+            checkers.setBit(sliders.getLS1B());
+        sliders.clearLS1B();
+    }
+    return checkers;
+}
 
-    while (bitboard.hasPieces()){
-        auto const knightSquare = bitboard.getLS1B();
-        Bitboard targetSquares = knightSquaresValid.at(knightSquare);
-        attackedSquares |= targetSquares;
-        squaresAttackedBySquare[knightSquare] |= targetSquares;
-        while (targetSquares.hasPieces()){
-            squaresAttackingSquare.at(targetSquares.getLS1B()).setBit(knightSquare);
+Bitboard MoveGenerator::getAttackersTo(Board const& board, Square square, Bitboard occupied){
+    const Bitboard squareBB = Bitboard::fromIndex64(square.getIndex64());
+    const Bitboard queens = board.getPieceTypeBitboard(PieceType::Queen);
+
+    // a piece attacks the square if the same piece on the square would attack it
+    Bitboard attackers = (knightSquaresValid.at(square.getIndex64()) & board.getPieceTypeBitboard(PieceType::Knight))
+                       | (kingSquaresValid.at(square.getIndex64()) & board.getPieceTypeBitboard(PieceType::King))
+                       | (pawnAttacks(squareBB, PieceColor::White) & board.getBitboard({PieceType::Pawn, PieceColor::Black}))
+                       | (pawnAttacks(squareBB, PieceColor::Black) & board.getBitboard({PieceType::Pawn, PieceColor::White}))
+                       | (allDirectionSlidingAttacks<0, 4>(occupied, squareBB) & (board.getPieceTypeBitboard(PieceType::Rook) | queens))
+                       | (allDirectionSlidingAttacks<4, 8>(occupied, squareBB) & (board.getPieceTypeBitboard(PieceType::Bishop) | queens));
+    return attackers & occupied;
+}
 
-            targetSquares.clearLS1B();
-        }
-        bitboard.clearLS1B();
-    }
+PositionInfo MoveGenerator::getPositionInfo() const{
+    PositionInfo info;
+    info.checkers = checkers;
+    info.attackedByThem = attackedSquares;
+    return info;
+}
 
-    // king moves
-    bitboard = board.getBitboard({PieceType::King, board.getColorToNotMove()});
-    if constexpr (Utils::BuildType::Current == Utils::BuildType::Debug){
-        if (!bitboard.hasPieces()) throw std::runtime_error("No king for the opposite color found.");
-    }
+void MoveGenerator::generateAttackData(Board const& board){
+    generatePins(board);
 
-    const auto kingSquare = bitboard.getLS1B();
-    bitboard = kingSquaresValid.at(kingSquare);
-    attackedSquares |= bitboard;
-    squaresAttackedBySquare[kingSquare] |= bitboard;
-    while(bitboard.hasPieces()){
-        squaresAttackingSquare.at(bitboard.getLS1B()).setBit(kingSquare);
-        bitboard.clearLS1B();
-    }
-    
-    // pawn moves
-    {
-        const Bitboard pawns = board.getBitboard({PieceType::Pawn, board.getColorToNotMove()});
-        const int8_t mainDirection = board.getCurrentState().isWhiteToMove ? DirectionIndex64::S : DirectionIndex64::N;
-
-        oppositeSlidingPiecesAndPawns |= pawns;
-
-        const int8_t reverseDirectionLeft = -mainDirection + DirectionIndex64::E;
-        const int8_t reverseDirectionRight = -mainDirection + DirectionIndex64::W;
-        Bitboard captures_left = ((pawns & 0xfefefefefefefefe) << (mainDirection + DirectionIndex64::W));
-        Bitboard captures_right = ((pawns & 0x7f7f7f7f7f7f7f7f) << (mainDirection + DirectionIndex64::E));
-        attackedSquares |= captures_left;
-        attackedSquares |= captures_right;
-        
-        while (captures_left.hasPieces()) {
-            const int target_square = captures_left.getLS1B();
-            const int origin_square = target_square + reverseDirectionLeft;
-            squaresAttackedBySquare.at(origin_square).setBit(target_square);
-            squaresAttackingSquare.at(target_square).setBit(origin_square);
-            captures_left.clearLS1B();
-        }
-        while (captures_right.hasPieces()) {
-            const int target_square = captures_right.getLS1B();
-            const int origin_square = target_square + reverseDirectionRight;
-            squaresAttackedBySquare.at(origin_square).setBit(target_square);
-            squaresAttackingSquare.at(target_square).setBit(origin_square);
-            captures_right.clearLS1B();
-        }
-    }
+    const PieceColor otherColor = board.getColorToNotMove();
+    const Bitboard knights = board.getBitboard({PieceType::Knight, otherColor});
+    const Bitboard pawns = board.getBitboard({PieceType::Pawn, otherColor});
 
+    // the sliding attacks go through the own king, so it can't move away along the attacking line
+    attackedSquares = getAttacks(board, otherColor, board.getAllPieceBitboard() ^ board.getBitboard({PieceType::King, board.getColorToMove()}));
 
     // generate target restriction
-    Bitboard kingBB = board.getBitboard({PieceType::King, board.getColorToMove()});
-    Bitboard attackers = squaresAttackingSquare.at(kingBB.getLS1B());
-    const auto preselection = obstructedLUT.at(kingBB.getLS1B());
+    // the knights and pawns attacking the king are the ones the king would attack as the same piece type
+    const Bitboard kingBB = board.getBitboard({PieceType::King, board.getColorToMove()});
+    const uint8_t kingSquare = kingBB.getLS1B();
+    checkers = sliderCheckers
+             | (knightSquaresValid.at(kingSquare) & knights)
+             | (pawnAttacks(kingBB, board.getColorToMove()) & pawns);
+    Bitboard attackers = checkers;
+    const auto preselection = obstructedLUT.at(kingSquare);
     isDoubleCheck = attackers.getNumPieces() >= 2;
     
     if (attackers.getNumPieces() >= 2){
         possibleTargets = 0;
     }
 
-    if ((attackers & board.getBitboard({PieceType::Knight, board.getColorToNotMove()})).hasPieces()){
+    if ((attackers & knights).hasPieces()){
         possibleTargets = attackers;
     }
     else if (attackers.hasPieces()){
-        attackers &= oppositeSlidingPiecesAndPawns;
         possibleTargets |= attackers;
         while (attackers.hasPieces()) {
             possibleTargets |= preselection.at(attackers.getLS1B());
@@ -274,49 +297,51 @@ void MoveGenerator::generateAttackData(Board const& board){
     }
 }
 
-void MoveGenerator::generateAllSlidingMoves(Board const& board, Bitboard targetMask){
-    auto const helper = [&]<int startIdx, int endIdx>(PieceType pieceType){
-        const PieceColor colorToMove = board.getColorToMove();
-        const Piece piece = {pieceType, colorToMove};
-        const Bitboard bitboard = board.getBitboard(piece);
-        Bitboard unpinnedBitboard = bitboard & ~pinnedPieces;
-        Bitboard pinnedBitboard = bitboard & pinnedPieces;
+void MoveGenerator::generateAttackMaps(Board const& board){
+    squaresAttackedBySquare.fill(Bitboard(0));
+    squaresAttackingSquare.fill(Bitboard(0));
 
-        while (unpinnedBitboard.hasPieces()){
-            Bitboard targetSquares = allDirectionSlidingAttacks<startIdx, endIdx>(board.getAllPieceBitboard(), Bitboard::fromIndex64(unpinnedBitboard.getLS1B()));
-            targetSquares &= ~board.getPieceBitboardForOneColor(colorToMove);
-            targetSquares &= targetMask;
+    const PieceColor otherColor = board.getColorToNotMove();
+    const Bitboard slidingBlockers = board.getAllPieceBitboard() ^ board.getBitboard({PieceType::King, board.getColorToMove()});
 
-            const Coordinate origin = Coordinate(unpinnedBitboard.getLS1B());
-            while (targetSquares.hasPieces()){
-                generatedMoves.emplace_back(origin, Coordinate(targetSquares.getLS1B()), piece);
-                targetSquares.clearLS1B();
-            }
-            
-            unpinnedBitboard.clearLS1B();
-        }
+    Bitboard pieces = board.getPieceBitboardForOneColor(otherColor);
+    while (pieces.hasPieces()){
+        const uint8_t origin_square = pieces.getLS1B();
+        const Piece piece = board.at(Square(origin_square));
+        Bitboard targetSquares = piece.type == PieceType::Pawn
+            ? pawnAttacks(Bitboard::fromIndex64(origin_square), otherColor)
+            : getPieceAttacks(piece.type, Square(origin_square), slidingBlockers);
 
-        while (pinnedBitboard.hasPieces()){
-            if (pinDirection.at(pinnedBitboard.getLS1B()).dir1 < startIdx || pinDirection.at(pinnedBitboard.getLS1B()).dir1 >= endIdx){
-                // the piece is pinned in a direction it can never move in
-                pinnedBitboard.clearLS1B();
-                continue;
-            }
+        squaresAttackedBySquare[origin_square] = targetSquares;
+        while (targetSquares.hasPieces()){
+            squaresAttackingSquare.at(targetSquares.getLS1B()).setBit(origin_square);
+            targetSquares.clearLS1B();
+        }
+        pieces.clearLS1B();
+    }
+}
 
-            Bitboard originBB = Bitboard::fromIndex64(pinnedBitboard.getLS1B());
-            Bitboard targetSquares = slidingAttacks(originBB, ~board.getAllPieceBitboard(), pinDirection.at(pinnedBitboard.getLS1B()).dir1);
-            targetSquares |=         slidingAttacks(originBB, ~board.getAllPieceBitboard(), pinDirection.at(pinnedBitboard.getLS1B()).dir2);
+void MoveGenerator::generateAllSlidingMoves(Board const& board, Bitboard targetMask){
+    auto const helper = [&]<int startIdx, int endIdx>(PieceType pieceType){
+        const PieceColor colorToMove = board.getColorToMove();
+        const Piece piece = {pieceType, colorToMove};
+        Bitboard bitboard = board.getBitboard(piece);
 
+        while (bitboard.hasPieces()){
+            const uint8_t origin_square = bitboard.getLS1B();
+            Bitboard targetSquares = allDirectionSlidingAttacks<startIdx, endIdx>(board.getAllPieceBitboard(), Bitboard::fromIndex64(origin_square));
             targetSquares &= ~board.getPieceBitboardForOneColor(colorToMove);
             targetSquares &= targetMask;
+            if (pinnedPieces.isOccupied(origin_square))
+                targetSquares &= pinLines[origin_square];
 
-            const Coordinate origin = Coordinate(pinnedBitboard.getLS1B());
+            const Square origin = Square(origin_square);
             while (targetSquares.hasPieces()){
-                generatedMoves.emplace_back(origin, Coordinate(targetSquares.getLS1B()), piece);
+                generatedMoves.emplace_back(origin, Square(targetSquares.getLS1B()), piece);
                 targetSquares.clearLS1B();
             }
             
-            pinnedBitboard.clearLS1B();
+            bitboard.clearLS1B();
         }
     };
     helper.operator()<0, 4>(PieceType::Rook);
@@ -324,13 +349,13 @@ void MoveGenerator::generateAllSlidingMoves(Board const& board, Bitboard targetM
     helper.operator()<0, 8>(PieceType::Queen);
 }
 
-void MoveGenerator::generateKnightMoves(Board const& board, Coordinate square, Bitboard targetMask){
+void MoveGenerator::generateKnightMoves(Board const& board, Square square, Bitboard targetMask){
     Bitboard targets = knightSquaresValid.at(square.getIndex64()) & ~board.getPieceBitboardForOneColor(board.getColorToMove()) & targetMask;
     const Piece piece = {PieceType::Knight, board.getColorToMove()};
 
     while (targets.hasPieces()){
         auto const target = targets.getLS1B();
-        generatedMoves.emplace_back(square, Coordinate(target), piece);
+        generatedMoves.emplace_back(square, Square(target), piece);
         targets.clearLS1B();
     }
 }
@@ -339,7 +364,7 @@ void MoveGenerator::generateAllKnightMoves(Board const& board, Bitboard targetMa
     Bitboard bitboard = board.getBitboard({PieceType::Knight, board.getColorToMove()}) & ~pinnedPieces;
 
     while (bitboard.hasPieces()){
-        generateKnightMoves(board, Coordinate(bitboard.getLS1B()), targetMask);
+        generateKnightMoves(board, Square(bitboard.getLS1B()), targetMask);
         bitboard.clearLS1B();
     }
 }
@@ -350,14 +375,14 @@ void MoveGenerator::generateAllKingMoves(Board const& board, Bitboard targetMask
 
     // TODO: maybe remove this since every position should have a king. Only there for debugging
     if (!bitboard.hasPieces()) return;
-    Coordinate square = Coordinate(bitboard.getLS1B());
+    Square square = Square(bitboard.getLS1B());
 
     Bitboard targets = kingSquaresValid.at(bitboard.getLS1B()) & ~(board.getPieceBitboardForOneColor(board.getColorToMove())  | attackedSquares);
     targets &= targetMask;
 
     while (targets.hasPieces()){
         auto const target = targets.getLS1B();
-        generatedMoves.emplace_back(square, Coordinate(target), piece);
+        generatedMoves.emplace_back(square, Square(target), piece);
         targets.clearLS1B();
     }
 
@@ -369,24 +394,24 @@ void MoveGenerator::generateAllKingMoves(Board const& board, Bitboard targetMask
         const Bitboard rightCastlingMapKing = Bitboard(0x000000000000000070) << shiftAmount;
 
         // add castling moves
-        if (board.getCurrentState().isWhiteToMove ? board.getCurrentState().canWhiteCastleRight : board.getCurrentState().canBlackCastleRight){
+        if (board.getCurrentState().isWhiteToMove ? board.getCurrentState().canWhiteCastleRight() : board.getCurrentState().canBlackCastleRight()){
             if (!uint64_t(rightCastlingMap & board.getAllPieceBitboard()) && !uint64_t(rightCastlingMapKing & attackedSquares)){
                     // king movement
-                    Move& move = generatedMoves.emplace_back(square, square + Direction::E*2, piece);
+                    Move& move = generatedMoves.emplace_back(square, square + DirectionIndex64::E*2, piece);
                     move.isCastling = true;
                     // rook movement
-                    move.castlingStart = square + Direction::E*3;
-                    move.castlingEnd = square + Direction::E;
+                    move.castlingStart = square + DirectionIndex64::E*3;
+                    move.castlingEnd = square + DirectionIndex64::E;
                 }
         }
-        if (board.getCurrentState().isWhiteToMove ? board.getCurrentState().canWhiteCastleLeft : board.getCurrentState().canBlackCastleLeft){
+        if (board.getCurrentState().isWhiteToMove ? board.getCurrentState().canWhiteCastleLeft() : board.getCurrentState().canBlackCastleLeft()){
             if (!uint64_t(leftCastlingMap & board.getAllPieceBitboard()) && !uint64_t(leftCastlingMapKing & attackedSquares)){
                     // king movement
-                    Move& move = generatedMoves.emplace_back(square, square + Direction::W*2, piece);
+                    Move& move = generatedMoves.emplace_back(square, square + DirectionIndex64::W*2, piece);
                     move.isCastling = true;
                     // rook movement
-                    move.castlingStart = square + Direction::W*4;
-                    move.castlingEnd = square + Direction::W;
+                    move.castlingStart = square + DirectionIndex64::W*4;
+                    move.castlingEnd = square + DirectionIndex64::W;
                 }
         }
     }
@@ -396,21 +421,10 @@ void MoveGenerator::generateAllPawnMoves(Board const& board, Bitboard targetMask
     const auto colorToMove = board.getColorToMove();
     const Piece piece = {PieceType::Pawn, colorToMove};
 
-
-    const Bitboard unpinnedPawns = board.getBitboard({PieceType::Pawn, colorToMove}) & ~pinnedPieces;
+    const Bitboard pawns = board.getBitboard({PieceType::Pawn, colorToMove});
     const Bitboard occupied = board.getAllPieceBitboard();
     const Bitboard occupied_other_color = board.getPieceBitboardForOneColor(board.getColorToNotMove());
 
-    Bitboard unpinnedPawnsLeft = unpinnedPawns, unpinnedPawnsRight = unpinnedPawns; 
-
-    Bitboard pawns = unpinnedPawns;
-    Bitboard pinnedPawns = board.getBitboard({PieceType::Pawn, colorToMove}) & pinnedPieces;
-    while (pinnedPawns.hasPieces()){
-        if (pinDirection.at(pinnedPawns.getLS1B()).dir1 == 0 || pinDirection.at(pinnedPawns.getLS1B()).dir2 == 0)
-            pawns.setBit(pinnedPawns.getLS1B());
-        pinnedPawns.clearLS1B();
-    }
-
     const int8_t mainDirection = board.getCurrentState().isWhiteToMove ? DirectionIndex64::N : DirectionIndex64::S;
     const Bitboard doublePushMask = board.getCurrentState().isWhiteToMove ? 0x0000000000ff0000 : 0x0000ff0000000000;
 
@@ -418,19 +432,10 @@ void MoveGenerator::generateAllPawnMoves(Board const& board, Bitboard targetMask
     const int8_t reverseDirectionLeft = reverseDirection + DirectionIndex64::E;
     const int8_t reverseDirectionRight = reverseDirection + DirectionIndex64::W;
 
-    const int allowedLeftDirection1 = board.getCurrentState().isWhiteToMove ? 4 : 6;
-    const int allowedLeftDirection2 = board.getCurrentState().isWhiteToMove ? 7 : 5;
-    const int allowedRightDirection1 = board.getCurrentState().isWhiteToMove ? 5 : 7;
-    const int allowedRightDirection2 = board.getCurrentState().isWhiteToMove ? 6 : 4;
-
-    pinnedPawns = board.getBitboard({PieceType::Pawn, colorToMove}) & pinnedPieces;
-    while (pinnedPawns.hasPieces()){
-        if (pinDirection.at(pinnedPawns.getLS1B()).dir1 == allowedLeftDirection1 || pinDirection.at(pinnedPawns.getLS1B()).dir1 == allowedLeftDirection2)
-            unpinnedPawnsLeft.setBit(pinnedPawns.getLS1B());
-        else if (pinDirection.at(pinnedPawns.getLS1B()).dir1 == allowedRightDirection1 || pinDirection.at(pinnedPawns.getLS1B()).dir1 == allowedRightDirection2)
-            unpinnedPawnsRight.setBit(pinnedPawns.getLS1B());
-        pinnedPawns.clearLS1B();
-    }
+    // pinned pawns are generated together with the others and only kept if they stay on their pin line
+    const auto staysOnPinLine = [&](int origin_square, int target_square){
+        return !pinnedPieces.isOccupied(origin_square) || pinLines[origin_square].isOccupied(target_square);
+    };
     
     if (!capturesOnly){
         Bitboard single_pushes = (pawns << mainDirection) & ~occupied;
@@ -440,93 +445,65 @@ void MoveGenerator::generateAllPawnMoves(Board const& board, Bitboard targetMask
         while (single_pushes.hasPieces()) {
             const int target_square = single_pushes.getLS1B();
             const int origin_square = target_square + reverseDirection;
-            addPawnMovePossiblyPromotion({Coordinate(origin_square), Coordinate(target_square)}, board);
+            if (staysOnPinLine(origin_square, target_square))
+                addPawnMovePossiblyPromotion({Square(origin_square), Square(target_square)}, board);
             single_pushes.clearLS1B();
         }
         while (double_pushes.hasPieces()) {
             const int target_square = double_pushes.getLS1B();
             const int origin_square = target_square + reverseDirection*2;
-            Move& move = generatedMoves.emplace_back(Coordinate(origin_square), Coordinate(target_square), piece);
-            move.isDoublePawnMove = true;
+            if (staysOnPinLine(origin_square, target_square)){
+                Move& move = generatedMoves.emplace_back(Square(origin_square), Square(target_square), piece);
+                move.isDoublePawnMove = true;
+            }
             double_pushes.clearLS1B();
         }
     }
     
-    Bitboard captures_left = ((unpinnedPawnsLeft & 0xfefefefefefefefe) << (mainDirection + DirectionIndex64::W)) & occupied_other_color & targetMask;
-    Bitboard captures_right = ((unpinnedPawnsRight & 0x7f7f7f7f7f7f7f7f) << (mainDirection + DirectionIndex64::E)) & occupied_other_color & targetMask;
+    Bitboard captures_left = ((pawns & 0xfefefefefefefefe) << (mainDirection + DirectionIndex64::W)) & occupied_other_color & targetMask;
+    Bitboard captures_right = ((pawns & 0x7f7f7f7f7f7f7f7f) << (mainDirection + DirectionIndex64::E)) & occupied_other_color & targetMask;
     
     while (captures_left.hasPieces()) {
         const int target_square = captures_left.getLS1B();
         const int origin_square = target_square + reverseDirectionLeft;
-        addPawnMovePossiblyPromotion({Coordinate(origin_square), Coordinate(target_square)}, board);
+        if (staysOnPinLine(origin_square, target_square))
+            addPawnMovePossiblyPromotion({Square(origin_square), Square(target_square)}, board);
         captures_left.clearLS1B();
     }
     while (captures_right.hasPieces()) {
         const int target_square = captures_right.getLS1B();
         const int origin_square = target_square + reverseDirectionRight;
-        addPawnMovePossiblyPromotion({Coordinate(origin_square), Coordinate(target_square)}, board);
+        if (staysOnPinLine(origin_square, target_square))
+            addPawnMovePossiblyPromotion({Square(origin_square), Square(target_square)}, board);
         captures_right.clearLS1B();
     }
 
     // en passant
     if (board.hasEnPassant()){
         auto const epCaptureSquare = board.getEnPassantSquareToCapture();
-        const Coordinate kingSquare = Coordinate(board.getBitboard({PieceType::King, colorToMove}).getLS1B()); 
-        const int correctY = board.getCurrentState().isWhiteToMove ? 4 : 3;
-        const Bitboard QandRsOnCorrectY = Bitboard(Utils::binaryOnes<uint64_t>(8) << correctY*8) & (board.getBitboard({PieceType::Rook, board.getColorToNotMove()}) | board.getBitboard({PieceType::Queen, board.getColorToNotMove()}));
-        // intentional shadow
-        const auto pawns = board.getBitboard({PieceType::Pawn, colorToMove}) | board.getBitboard({PieceType::Pawn, board.getColorToNotMove()});
-
-        auto const oneSideEP = [&](int side, Coordinate direction, int ignoreX){
-            auto const originSquare = epCaptureSquare + direction;
-            if (epCaptureSquare.x == ignoreX || !board.getBitboard({PieceType::Pawn, colorToMove}).isOccupied(originSquare)) return;
-
-            const Bitboard theTwoPawnsBB = Bitboard::fromIndex64(epCaptureSquare.getIndex64()) | Bitboard::fromIndex64(epCaptureSquare.getIndex64()+side);
-            const Bitboard modifiedOccupied = occupied & ~theTwoPawnsBB;
-            if (kingSquare.y == correctY){
-                // the pawns might be "pinned"
-                int dir = kingSquare.getIndex64() < epCaptureSquare.getIndex64() ? 1 : -1;
-                int stopSquare = (kingSquare.getIndex64() / 8) * 8 + (dir == 1 ? 8 : -1);
-                // loop until queen or rook
-                for (int square = kingSquare.getIndex64()+dir; square != stopSquare; square += dir){
-                    if (QandRsOnCorrectY.isOccupied(square)) return;
-                    if (modifiedOccupied.isOccupied(square)) break;
-                }
-            }
-
-            // handle individually pinned pawns
-            // the moving pawn
-            if (pinnedPieces.isOccupied(originSquare)){
-                int allowedPinDirection;
-                switch(mainDirection - side){
-                    case DirectionIndex64::NW: allowedPinDirection = 4; break;
-                    case DirectionIndex64::NE: allowedPinDirection = 5; break;
-                    case DirectionIndex64::SW: allowedPinDirection = 6; break;
-                    case DirectionIndex64::SE: allowedPinDirection = 7; break;
-                }
-                auto actualDirection = pinDirection.at(originSquare.getIndex64());
-
-                // test if the pawn is pinned
-                if (actualDirection.dir1 != allowedPinDirection && actualDirection.dir2 != allowedPinDirection) return;
-            }
-
-            // the pawn getting captured
-            if (pinnedPieces.isOccupied(epCaptureSquare)){
-                const int allowedPinDirection = 0; // vertical pins are fine
-                auto actualDirection = pinDirection.at(epCaptureSquare.getIndex64());
-
-                // test if the pawn is pinned
-                if (actualDirection.dir1 != allowedPinDirection && actualDirection.dir2 != allowedPinDirection) return;
-            }
-
-            Move& move = generatedMoves.emplace_back(originSquare, board.getEnPassantSquareForFEN(), piece);
+        auto const epTargetSquare = board.getEnPassantSquareForFEN();
+        const Bitboard kingBB = board.getBitboard({PieceType::King, colorToMove});
+        const Bitboard queens = board.getBitboard({PieceType::Queen, board.getColorToNotMove()});
+        const Bitboard rooksAndQueens = board.getBitboard({PieceType::Rook, board.getColorToNotMove()}) | queens;
+        const Bitboard bishopsAndQueens = board.getBitboard({PieceType::Bishop, board.getColorToNotMove()}) | queens;
+
+        auto const oneSideEP = [&](int side, int ignoreFile){
+            auto const originSquare = epCaptureSquare + side;
+            if (epCaptureSquare.getFile() == ignoreFile || !pawns.isOccupied(originSquare)) return;
+
+            // both pawns leave their squares at once, which pins can't describe, so test the resulting position directly
+            const Bitboard occupiedAfterCapture = (occupied & ~(Bitboard::fromIndex64(originSquare.getIndex64()) | Bitboard::fromIndex64(epCaptureSquare.getIndex64()))) | Bitboard::fromIndex64(epTargetSquare.getIndex64());
+            if ((allDirectionSlidingAttacks<0, 4>(occupiedAfterCapture, kingBB) & rooksAndQueens).hasPieces()) return;
+            if ((allDirectionSlidingAttacks<4, 8>(occupiedAfterCapture, kingBB) & bishopsAndQueens).hasPieces()) return;
+
+            Move& move = generatedMoves.emplace_back(originSquare, epTargetSquare, piece);
             move.isEnPassant = true;
         };
 
-        bool onlyPossibleMove = targetMask.getNumPieces() == 1 && targetMask.isOccupied(board.getEnPassantSquareForFEN().getIndex64() + reverseDirection);
-        if (targetMask.isOccupied(board.getEnPassantSquareForFEN()) || onlyPossibleMove){
-            oneSideEP(-1, Direction::W, 0);
-            oneSideEP(1, Direction::E, 7);
+        bool onlyPossibleMove = targetMask.getNumPieces() == 1 && targetMask.isOccupied(epTargetSquare.getIndex64() + reverseDirection);
+        if (targetMask.isOccupied(epTargetSquare) || onlyPossibleMove){
+            oneSideEP(-1, 0);
+            oneSideEP(1, 7);
         }
     }
 }
@@ -534,7 +511,7 @@ void MoveGenerator::generateAllPawnMoves(Board const& board, Bitboard targetMask
 void MoveGenerator::addPawnMovePossiblyPromotion(Move move, Board const& board){
     const uint8_t targetLine = board.getCurrentState().isWhiteToMove ? 7 : 0;
     move.piece = {PieceType::Pawn, board.getColorToMove()};
-    if (move.endIndex.y == targetLine){
+    if (move.endIndex.getRank() == targetLine){
         // promotion
         for (PieceType promotionType : Utils::promotionPieces){
             Move& newMove = generatedMoves.emplace_back(move);
@@ -0,0 +1,96 @@
+#include "Thera/OpeningBook.hpp"
+#include "Thera/Board.hpp"
+#include "Thera/MoveGenerator.hpp"
+
+#include <stdexcept>
+
+namespace Thera{
+
+template<typename T>
+static void writeBigEndian(std::ostream& stream, T value){
+    for (int i=sizeof(T)-1; i>=0; i--){
+        stream.put(static_cast<char>((value >> (i*8)) & 0xFF));
+    }
+}
+
+template<typename T>
+static T readBigEndian(const unsigned char* bytes){
+    T value = 0;
+    for (size_t i=0; i<sizeof(T); i++){
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+void OpeningBook::writeEntry(std::ostream& stream, Entry const& entry){
+    writeBigEndian(stream, entry.key);
+    writeBigEndian(stream, entry.move);
+    writeBigEndian(stream, entry.weight);
+    writeBigEndian(stream, entry.learn);
+}
+
+bool OpeningBook::readEntry(std::istream& stream, Entry& entry){
+    unsigned char bytes[entrySize];
+    if (!stream.read(reinterpret_cast<char*>(bytes), entrySize)) return false;
+
+    entry.key = readBigEndian<uint64_t>(bytes);
+    entry.move = readBigEndian<uint16_t>(bytes + 8);
+    entry.weight = readBigEndian<uint16_t>(bytes + 10);
+    entry.learn = readBigEndian<uint32_t>(bytes + 12);
+    return true;
+}
+
+void OpeningBook::open(std::string const& path){
+    file = std::ifstream(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) throw std::runtime_error("Unable to open book \"" + path + "\"");
+
+    numEntries = static_cast<uint64_t>(file.tellg()) / entrySize;
+}
+
+OpeningBook::Entry OpeningBook::readEntryAt(uint64_t index){
+    Entry entry;
+    file.clear();
+    file.seekg(index * entrySize);
+    if (!readEntry(file, entry)) throw std::runtime_error("Unable to read book entry");
+    return entry;
+}
+
+std::vector<OpeningBook::Entry> OpeningBook::getEntries(uint64_t key){
+    std::vector<Entry> result;
+
+    // find the first entry with a key >= key
+    uint64_t low = 0, high = numEntries;
+    while (low < high){
+        const uint64_t middle = low + (high - low) / 2;
+        if (readEntryAt(middle).key < key) low = middle + 1;
+        else high = middle;
+    }
+
+    for (uint64_t i = low; i < numEntries; i++){
+        Entry entry = readEntryAt(i);
+        if (entry.key != key) break;
+        result.push_back(entry);
+    }
+    return result;
+}
+
+std::vector<OpeningBook::WeightedMove> OpeningBook::getMoves(Board const& board, MoveGenerator& generator){
+    std::vector<WeightedMove> result;
+    if (!isOpen()) return result;
+
+    const auto entries = getEntries(board.getCurrentHash());
+    if (entries.empty()) return result;
+
+    for (auto const& move : generator.generateAllMoves(board)){
+        const uint16_t encoded = move.encode();
+        for (auto const& entry : entries){
+            if (entry.move == encoded){
+                result.push_back({move, entry.weight});
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+}
@@ -0,0 +1,58 @@
+#include "Thera/SearchTreeDump.hpp"
+
+#include <array>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace Thera{
+
+// records are buffered per thread, so the file is only locked once per block
+static constexpr size_t recordsPerBlock = 1 << 14;
+
+static std::mutex fileMutex;
+static std::ofstream file;
+
+static thread_local std::vector<SearchTreeDump::Record> buffer;
+static thread_local std::array<uint16_t, 256> movesByPly = {};
+
+void SearchTreeDump::open(std::string const& path){
+    std::scoped_lock lock(fileMutex);
+    if (file.is_open()) file.close();
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) throw std::runtime_error("Could not open the search tree dump \"" + path + "\"");
+}
+
+void SearchTreeDump::close(){
+    flush();
+    std::scoped_lock lock(fileMutex);
+    file.close();
+}
+
+bool SearchTreeDump::isOpen(){
+    std::scoped_lock lock(fileMutex);
+    return file.is_open();
+}
+
+void SearchTreeDump::setMove(int ply, uint16_t move){
+    movesByPly[ply % movesByPly.size()] = move;
+}
+
+void SearchTreeDump::write(Record record){
+    record.move = record.ply == 0 ? 0 : movesByPly[(record.ply - 1) % movesByPly.size()];
+    buffer.push_back(record);
+    if (buffer.size() >= recordsPerBlock) flush();
+}
+
+void SearchTreeDump::flush(){
+    {
+        std::scoped_lock lock(fileMutex);
+        if (file.is_open()){
+            file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(Record));
+        }
+    }
+    buffer.clear();
+}
+
+}
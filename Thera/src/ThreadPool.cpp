@@ -0,0 +1,127 @@
+#include "Thera/ThreadPool.hpp"
+#include "Thera/Utils/Topology.hpp"
+
+#include <stdexcept>
+
+namespace Thera{
+
+ThreadPool::ThreadPool(int numThreads, bool pinToNumaNodes){
+    resize(numThreads, pinToNumaNodes);
+}
+
+ThreadPool::~ThreadPool(){
+    stopWorkers();
+}
+
+void ThreadPool::resize(int numThreads, bool pinToNumaNodes){
+    if (numThreads < 1) throw std::invalid_argument("A thread pool needs at least one thread");
+
+    stopWorkers();
+
+    shouldExit = false;
+    workerQueues = std::vector<std::deque<Task>>(numThreads);
+    for (int i=0; i<numThreads; i++){
+        workers.emplace_back(&ThreadPool::workerFunction, this, i, pinToNumaNodes);
+    }
+}
+
+void ThreadPool::stopWorkers(){
+    if (workers.empty()) return;
+
+    wait();
+    {
+        std::lock_guard lock(mutex);
+        shouldExit = true;
+    }
+    taskAvailableCond.notify_all();
+
+    for (auto& worker : workers){
+        worker.join();
+    }
+    workers.clear();
+}
+
+void ThreadPool::submit(Task task){
+    {
+        std::lock_guard lock(mutex);
+        sharedQueue.push_back(std::move(task));
+        numPendingTasks++;
+    }
+    taskAvailableCond.notify_one();
+}
+
+void ThreadPool::submitToAll(Task task){
+    {
+        std::lock_guard lock(mutex);
+        for (auto& queue : workerQueues){
+            queue.push_back(task);
+            numPendingTasks++;
+        }
+    }
+    taskAvailableCond.notify_all();
+}
+
+void ThreadPool::wait(){
+    std::unique_lock lock(mutex);
+    allDoneCond.wait(lock, [&](){ return numPendingTasks == 0 && numRunningTasks == 0; });
+
+    if (firstException){
+        std::exception_ptr exception = firstException;
+        firstException = nullptr;
+        std::rethrow_exception(exception);
+    }
+}
+
+bool ThreadPool::isBusy(){
+    std::lock_guard lock(mutex);
+    return numPendingTasks != 0 || numRunningTasks != 0;
+}
+
+bool ThreadPool::hasTaskFor(int workerIndex) const{
+    return workerQueues.at(workerIndex).size() || sharedQueue.size();
+}
+
+void ThreadPool::workerFunction(int workerIndex, bool pinToNumaNodes){
+    if (pinToNumaNodes){
+        const auto topology = Utils::getNumaTopology();
+        Utils::pinCurrentThread(Utils::getNodeForThread(workerIndex, workerQueues.size(), topology).cpus);
+    }
+
+    while (true){
+        // spin for a short time to keep the latency low for consecutive tasks
+        for (int i=0; i<spinIterations && numPendingTasks == 0; i++){
+            std::this_thread::yield();
+        }
+
+        Task task;
+        {
+            std::unique_lock lock(mutex);
+            taskAvailableCond.wait(lock, [&](){ return shouldExit || hasTaskFor(workerIndex); });
+            if (!hasTaskFor(workerIndex)) return;
+
+            auto& queue = workerQueues.at(workerIndex).size() ? workerQueues.at(workerIndex) : sharedQueue;
+            task = std::move(queue.front());
+            queue.pop_front();
+            numPendingTasks--;
+            numRunningTasks++;
+        }
+
+        try{
+            task(workerIndex);
+        }
+        catch(...){
+            std::lock_guard lock(mutex);
+            if (!firstException) firstException = std::current_exception();
+        }
+
+        bool isDone;
+        {
+            std::lock_guard lock(mutex);
+            numRunningTasks--;
+            isDone = numPendingTasks == 0 && numRunningTasks == 0;
+        }
+        if (isDone) allDoneCond.notify_all();
+    }
+}
+
+}
@@ -1,45 +1,135 @@
 #include "Thera/TranspositionTable.hpp"
 
+#include <bit>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+
 namespace Thera{
 
+TranspositionTable::TranspositionTable(size_t sizeMB){
+    resize(sizeMB, false);
+}
+
+void TranspositionTable::resize(size_t sizeMB, bool prefault, bool interleaveNumaNodes){
+    // free the old table first to avoid having both in memory
+    memory = Utils::LargeMemoryBlock();
+    shared = false;
+
+    numBuckets = std::bit_floor(std::max<size_t>(sizeMB * 1024 * 1024 / sizeof(Bucket), 1));
+    memory = Utils::LargeMemoryBlock(numBuckets * sizeof(Bucket), interleaveNumaNodes);
+    buckets = static_cast<Bucket*>(memory.data());
+
+    if (prefault)
+        clear(std::thread::hardware_concurrency());
+}
+
+void TranspositionTable::openShared(std::string const& name, size_t sizeMB){
+    const size_t newNumBuckets = std::bit_floor(std::max<size_t>(sizeMB * 1024 * 1024 / sizeof(Bucket), 1));
+    // only replace the table once the shared one could be mapped
+    memory = Utils::LargeMemoryBlock::openShared(name, newNumBuckets * sizeof(Bucket));
+    numBuckets = newNumBuckets;
+    buckets = static_cast<Bucket*>(memory.data());
+    shared = true;
+    generation.store(0, std::memory_order_relaxed);
+}
+
+void TranspositionTable::clear(int numThreads){
+    memory.clear(numThreads);
+}
+
+// other processes sharing the table only synchronize through the entries themselves
+static_assert(std::atomic_ref<uint64_t>::is_always_lock_free, "TT entries have to be lock free to be shared between processes");
+
+TranspositionTable::Entry::Data TranspositionTable::loadEntry(Entry& entry, uint64_t& key){
+    const uint64_t data = std::atomic_ref(entry.data).load(std::memory_order_relaxed);
+    key = std::atomic_ref(entry.keyXorData).load(std::memory_order_relaxed) ^ data;
+    return std::bit_cast<Entry::Data>(data);
+}
+
+void TranspositionTable::storeEntry(Entry& entry, uint64_t key, Entry::Data data){
+    const uint64_t rawData = std::bit_cast<uint64_t>(data);
+    std::atomic_ref(entry.keyXorData).store(key ^ rawData, std::memory_order_relaxed);
+    std::atomic_ref(entry.data).store(rawData, std::memory_order_relaxed);
+}
+
 void TranspositionTable::addEntry(Board const& board, int eval, NegamaxState nstate){
-    Entry entry;
-    entry.eval = eval;
-    entry.depth = nstate.depth;
+    Entry::Data data;
+    data.eval = eval;
+    data.depth = nstate.depth;
 
-    if (entry.eval <= nstate.alpha){
-        entry.flag = Entry::Flag::UpperBound;
+    if (data.eval <= nstate.alpha){
+        data.flag = Entry::Flag::UpperBound;
     }
-    else if (entry.eval >= nstate.beta){
-        entry.flag = Entry::Flag::LowerBound;
+    else if (data.eval >= nstate.beta){
+        data.flag = Entry::Flag::LowerBound;
     }
     else{
-        entry.flag = Entry::Flag::Exact;
+        data.flag = Entry::Flag::Exact;
     }
 
-    internalTable.insert_or_assign(board.getCurrentHash(), entry);
+    storeEntry(board.getCurrentHash(), data);
+
+    if (deepEntryListener && data.depth >= deepEntryMinDepth){
+        deepEntryListener(board.getCurrentHash(), data);
+    }
+}
+
+void TranspositionTable::storeEntry(uint64_t key, Entry::Data data){
+    Bucket& bucket = getBucket(key);
+    const uint8_t currentGeneration = generation.load(std::memory_order_relaxed);
+    data.generation = currentGeneration;
+
+    // replace the same position or the least valuable entry, entries lose value with every search since they were stored
+    constexpr int agePenalty = 8;
+    Entry* replacedEntry = nullptr;
+    int replacedValue = 0;
+    for (auto& entry : bucket.entries){
+        uint64_t entryKey;
+        const Entry::Data entryData = loadEntry(entry, entryKey);
+        if (entryKey == key){
+            replacedEntry = &entry;
+            break;
+        }
+        const uint8_t age = currentGeneration - entryData.generation;
+        const int value = entryData.depth - agePenalty * age;
+        if (replacedEntry == nullptr || value < replacedValue){
+            replacedEntry = &entry;
+            replacedValue = value;
+        }
+    }
+
+    storeEntry(*replacedEntry, key, data);
+}
+
+void TranspositionTable::setDeepEntryListener(int minDepth, std::function<void(uint64_t key, Entry::Data data)> listener){
+    deepEntryMinDepth = minDepth;
+    deepEntryListener = listener;
 }
 
 std::optional<int> TranspositionTable::readPotentialEntry(Board const& board, NegamaxState& nstate){
-    if (internalTable.contains(board.getCurrentHash())){
-        auto entry = internalTable.at(board.getCurrentHash());
-        if (entry.depth >= nstate.depth){
-            if (entry.flag == Entry::Flag::Exact){
-                return entry.eval;
-            }
-            else if (entry.flag == Entry::Flag::LowerBound){
-                nstate.alpha = std::max(nstate.alpha, entry.eval);
-            }
-            else if (entry.flag == Entry::Flag::UpperBound){
-                nstate.beta = std::min(nstate.beta, entry.eval);
-            }
-            if (nstate.alpha > nstate.beta){
-                return entry.eval;
-            }
+    const uint64_t key = board.getCurrentHash();
+    for (auto& entry : getBucket(key).entries){
+        uint64_t entryKey;
+        const Entry::Data data = loadEntry(entry, entryKey);
+        if (entryKey != key || data.depth < nstate.depth) continue;
+
+        if (data.flag == Entry::Flag::Exact){
+            return data.eval;
         }
+        else if (data.flag == Entry::Flag::LowerBound){
+            nstate.alpha = std::max(nstate.alpha, data.eval);
+        }
+        else if (data.flag == Entry::Flag::UpperBound){
+            nstate.beta = std::min(nstate.beta, data.eval);
+        }
+        if (nstate.alpha > nstate.beta){
+            return data.eval;
+        }
+        break;
     }
 
     return {};
 }
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,154 @@
+#include "Thera/Utils/Memory.hpp"
+#include "Thera/Utils/Topology.hpp"
+
+#include <stdexcept>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+#if defined(__linux__)
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <cerrno>
+#endif
+
+namespace Thera::Utils{
+
+LargeMemoryBlock::LargeMemoryBlock(size_t size, bool interleaveNumaNodes): usableSize(size){
+    if (size == 0) return;
+
+#if defined(__linux__)
+    // explicit huge pages have to be reserved by the administrator, so this often fails
+    const size_t hugePageAlignedSize = (size + hugePageSize - 1) / hugePageSize * hugePageSize;
+    mapping = mmap(nullptr, hugePageAlignedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (mapping != MAP_FAILED){
+        mappingSize = hugePageAlignedSize;
+        alignedData = mapping;
+        explicitHugePages = true;
+        if (interleaveNumaNodes) interleaveMemoryAcrossNodes(alignedData, mappingSize);
+        return;
+    }
+
+    // over-allocate to align the block to a huge page boundary for transparent huge pages
+    mappingSize = size + hugePageSize;
+    mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED){
+        mapping = nullptr;
+        throw std::bad_alloc();
+    }
+    const uintptr_t alignedAddress = (reinterpret_cast<uintptr_t>(mapping) + hugePageSize - 1) / hugePageSize * hugePageSize;
+    alignedData = reinterpret_cast<void*>(alignedAddress);
+    madvise(alignedData, size, MADV_HUGEPAGE);
+    if (interleaveNumaNodes) interleaveMemoryAcrossNodes(alignedData, size);
+#else
+    const size_t alignment = 64;
+    mappingSize = (size + alignment - 1) / alignment * alignment;
+    mapping = std::aligned_alloc(alignment, mappingSize);
+    if (!mapping) throw std::bad_alloc();
+    alignedData = mapping;
+    std::memset(alignedData, 0, usableSize);
+#endif
+}
+
+LargeMemoryBlock::~LargeMemoryBlock(){
+    release();
+}
+
+LargeMemoryBlock::LargeMemoryBlock(LargeMemoryBlock&& other){
+    *this = std::move(other);
+}
+
+LargeMemoryBlock& LargeMemoryBlock::operator = (LargeMemoryBlock&& other){
+    if (this == &other) return *this;
+
+    release();
+    std::swap(mapping, other.mapping);
+    std::swap(mappingSize, other.mappingSize);
+    std::swap(alignedData, other.alignedData);
+    std::swap(usableSize, other.usableSize);
+    std::swap(explicitHugePages, other.explicitHugePages);
+    return *this;
+}
+
+LargeMemoryBlock LargeMemoryBlock::openShared(std::string const& name, size_t size){
+#if defined(__linux__)
+    const bool isSharedMemorySegment = name.size() > 1 && name.front() == '/' && name.find('/', 1) == std::string::npos;
+    const int fd = isSharedMemorySegment ? shm_open(name.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600) : open(name.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd == -1) throw std::runtime_error("Unable to open shared memory \"" + name + "\": " + strerror(errno));
+
+    const auto fail = [&](std::string const& message){
+        const std::string text = message + " \"" + name + "\": " + strerror(errno);
+        close(fd);
+        throw std::runtime_error(text);
+    };
+
+    struct stat status;
+    if (fstat(fd, &status) != 0) fail("Unable to get the size of shared memory");
+    // the processes have to agree on the size, since it determines where data is stored
+    if (status.st_size != 0 && size_t(status.st_size) != size){
+        errno = EINVAL;
+        fail("Different size of existing shared memory");
+    }
+    // truncating is a no-op if another process created it first, new memory is zero filled
+    if (ftruncate(fd, size) != 0) fail("Unable to resize shared memory");
+
+    LargeMemoryBlock block;
+    block.mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (block.mapping == MAP_FAILED){
+        block.mapping = nullptr;
+        fail("Unable to map shared memory");
+    }
+    close(fd);
+
+    block.mappingSize = size;
+    block.alignedData = block.mapping;
+    block.usableSize = size;
+    madvise(block.alignedData, size, MADV_HUGEPAGE);
+    return block;
+#else
+    throw std::runtime_error("Shared memory is only supported on Linux");
+#endif
+}
+
+void LargeMemoryBlock::release(){
+    if (!mapping) return;
+
+#if defined(__linux__)
+    munmap(mapping, mappingSize);
+#else
+    std::free(mapping);
+#endif
+    mapping = nullptr;
+    mappingSize = 0;
+    alignedData = nullptr;
+    usableSize = 0;
+    explicitHugePages = false;
+}
+
+void LargeMemoryBlock::clear(int numThreads){
+    numThreads = std::max(numThreads, 1);
+    // every thread gets a contiguous, page aligned slice
+    const size_t sliceSize = (usableSize / numThreads + hugePageSize - 1) / hugePageSize * hugePageSize;
+
+    std::vector<std::thread> threads;
+    for (int i=1; i<numThreads; i++){
+        const size_t begin = i * sliceSize;
+        if (begin >= usableSize) break;
+        threads.emplace_back([=, this](){
+            std::memset(static_cast<char*>(alignedData) + begin, 0, std::min(sliceSize, usableSize - begin));
+        });
+    }
+    std::memset(alignedData, 0, std::min(sliceSize, usableSize));
+
+    for (auto& thread : threads){
+        thread.join();
+    }
+}
+
+}
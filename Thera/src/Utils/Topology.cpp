@@ -0,0 +1,101 @@
+#include "Thera/Utils/Topology.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <algorithm>
+#include <cstdint>
+
+#if defined(__linux__)
+    #include <sched.h>
+    #include <unistd.h>
+    #include <sys/syscall.h>
+#endif
+
+namespace Thera::Utils{
+
+std::vector<int> parseCPUList(std::string const& list){
+    std::vector<int> result;
+    std::stringstream stream(list);
+    std::string range;
+    while (std::getline(stream, range, ',')){
+        if (range.find_first_of("0123456789") == std::string::npos) continue;
+
+        const size_t dash = range.find('-');
+        const int first = std::stoi(range.substr(0, dash));
+        const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash+1));
+        for (int i=first; i<=last; i++){
+            result.push_back(i);
+        }
+    }
+    return result;
+}
+
+static std::string readFirstLine(std::string const& path){
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+
+std::vector<NumaNode> getNumaTopology(){
+    std::vector<NumaNode> topology;
+
+    for (int node : parseCPUList(readFirstLine("/sys/devices/system/node/online"))){
+        NumaNode& numaNode = topology.emplace_back();
+        numaNode.id = node;
+        numaNode.cpus = parseCPUList(readFirstLine("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"));
+        // memory-only nodes can't run threads
+        if (numaNode.cpus.empty()) topology.pop_back();
+    }
+
+    if (topology.empty()){
+        NumaNode& numaNode = topology.emplace_back();
+        numaNode.id = 0;
+        for (int cpu=0; cpu < std::max<int>(std::thread::hardware_concurrency(), 1); cpu++){
+            numaNode.cpus.push_back(cpu);
+        }
+    }
+    return topology;
+}
+
+NumaNode const& getNodeForThread(int threadIndex, int numThreads, std::vector<NumaNode> const& topology){
+    const int nodeIndex = (static_cast<int64_t>(threadIndex) * topology.size()) / std::max(numThreads, 1);
+    return topology.at(std::min<int>(nodeIndex, topology.size() - 1));
+}
+
+bool pinCurrentThread(std::vector<int> const& cpus){
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus){
+        if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+bool interleaveMemoryAcrossNodes(void* memory, size_t size){
+#if defined(__linux__) && defined(SYS_mbind)
+    // mbind is used through syscall() to avoid depending on libnuma
+    static constexpr int mpolInterleave = 3; // MPOL_INTERLEAVE from <numaif.h>
+    static constexpr int maxNodes = 1024;
+
+    uint64_t nodeMask[maxNodes / 64] = {};
+    bool hasNodes = false;
+    for (int node : parseCPUList(readFirstLine("/sys/devices/system/node/has_memory"))){
+        if (node >= maxNodes) continue;
+        nodeMask[node / 64] |= uint64_t(1) << (node % 64);
+        hasNodes = true;
+    }
+    if (!hasNodes) return false;
+
+    return syscall(SYS_mbind, memory, size, mpolInterleave, nodeMask, maxNodes, 0) == 0;
+#else
+    return false;
+#endif
+}
+
+}
@@ -80,7 +80,7 @@ PerftResult perft_instrumented(Board& board, MoveGenerator& generator, int depth
     return result;
 }
 
-template<bool bulkCounting>
+template<bool bulkCounting, MoveApplication application = searchMoveApplication>
 static uint64_t perftHelper(Board& board, MoveGenerator& generator, int depth){
     if (depth == 0) return 1;
 
@@ -91,9 +91,9 @@ static uint64_t perftHelper(Board& board, MoveGenerator& generator, int depth){
 
     uint64_t numNodes = 0;
     for (auto const& move : moves){
-        board.applyMove(move);
-        numNodes += perftHelper<bulkCounting>(board, generator, depth-1);
-        board.rewindMove();
+        board.applyMove<application>(move);
+        numNodes += perftHelper<bulkCounting, application>(board, generator, depth-1);
+        board.rewindMove<application>();
     }
 
     return numNodes;
@@ -114,9 +114,9 @@ PerftResult perft(Board& board, MoveGenerator& generator, int depth, bool bulkCo
     }
 
     for (auto move : moves){
-        board.applyMove(move);
+        board.applyMove<searchMoveApplication>(move);
         Utils::ScopeGuard boardRestore([&](){
-            board.rewindMove();
+            board.rewindMove<searchMoveApplication>();
         });
         
         uint64_t tmp;
@@ -131,4 +131,32 @@ PerftResult perft(Board& board, MoveGenerator& generator, int depth, bool bulkCo
     return result;
 }
 
-}
\ No newline at end of file
+PerftResult perft(Board const& board, int depth, bool bulkCounting, ThreadPool& pool){
+    Board rootBoard = board;
+    MoveGenerator rootGenerator;
+    if (depth <= 1) return perft(rootBoard, rootGenerator, depth, bulkCounting);
+
+    PerftResult result;
+    const auto moves = rootGenerator.generateAllMoves(rootBoard);
+    result.moves.resize(moves.size());
+
+    for (size_t i=0; i<moves.size(); i++){
+        pool.submit([&, i](int){
+            Board taskBoard = board;
+            MoveGenerator generator;
+
+            taskBoard.applyMove<searchMoveApplication>(moves.at(i));
+            if (bulkCounting) result.moves.at(i) = {moves.at(i), perftHelper<true>(taskBoard, generator, depth-1)};
+            else              result.moves.at(i) = {moves.at(i), perftHelper<false>(taskBoard, generator, depth-1)};
+        });
+    }
+    pool.wait();
+
+    for (auto const& move : result.moves){
+        result.numNodesSearched += move.numNodesSearched;
+    }
+
+    return result;
+}
+
+}
@@ -1,5 +1,8 @@
 #include "Thera/search.hpp"
 #include "Thera/TranspositionTable.hpp"
+#include "Thera/AnalysisCache.hpp"
+#include "Thera/ThreadPool.hpp"
+#include "Thera/SearchTreeDump.hpp"
 #include "Thera/Utils/ChessTerms.hpp"
 #include "Thera/Utils/ScopeGuard.hpp"
 #include "Thera/Utils/ChessTerms.hpp"
@@ -9,6 +12,7 @@
 #include <algorithm>
 #include <unordered_map>
 #include <array>
+#include <vector>
 
 namespace Thera{
 
@@ -99,7 +103,44 @@ static const std::array<std::array<int, 64>, 7> simplifiedEvalScores{
 }
 
 
-std::vector<Move> preorderMoves(std::vector<Move> const&& moves, Board& board, MoveGenerator& generator){
+/**
+ * @brief How often quiet moves caused beta cutoffs, indexed by the color and the start and end squares.
+ * 
+ * Every search thread has its own table, which is discarded after the search.
+ */
+class HistoryTable{
+    public:
+        // the scores stay within [-maxScore, maxScore], below the scores of captures when ordering moves
+        static constexpr int maxScore = 1 << 14;
+
+        int get(PieceColor color, Move const& move) const{
+            return scores[static_cast<int>(color)][move.startIndex.getIndex64()][move.endIndex.getIndex64()];
+        }
+
+        /**
+         * @brief Reward or penalize a quiet move.
+         * 
+         * The change shrinks as the score approaches the bounds, so moves that stop causing cutoffs can recover.
+         * 
+         * @param color the color making the move
+         * @param move the move
+         * @param bonus positive for a cutoff, negative for a move searched before the cutoff
+         */
+        void update(PieceColor color, Move const& move, int bonus){
+            int& score = scores[static_cast<int>(color)][move.startIndex.getIndex64()][move.endIndex.getIndex64()];
+            bonus = std::clamp(bonus, -maxScore, maxScore);
+            score += bonus - score * std::abs(bonus) / maxScore;
+        }
+
+    private:
+        std::array<std::array<std::array<int, 64>, 64>, 2> scores = {};
+};
+
+static bool isQuietMove(Move const& move, Board const& board){
+    return !move.isEnPassant && move.promotionType == PieceType::None && !board.getAllPieceBitboard().isOccupied(move.endIndex);
+}
+
+std::vector<Move> preorderMoves(std::vector<Move> const&& moves, Board& board, PositionInfo const& info, HistoryTable const* history = nullptr){
     struct ScoredMove{
         Move move;
         int score = 0;
@@ -117,10 +158,6 @@ std::vector<Move> preorderMoves(std::vector<Move> const&& moves, Board& board, M
     std::vector<ScoredMove> scoredMoves;
     scoredMoves.reserve(moves.size());
 
-    board.switchPerspective();
-    generator.generateAttackData(board);
-    board.switchPerspective();
-
     for (auto move : moves){
         ScoredMove& scoredMove = scoredMoves.emplace_back();
         scoredMove.move = move;
@@ -128,7 +165,7 @@ std::vector<Move> preorderMoves(std::vector<Move> const&& moves, Board& board, M
         Piece capturedPiece = board.at(move.endIndex);
         if (capturedPiece.type != PieceType::None){
             int pieceValueDifference = EvaluationValues::pieceValues.at(capturedPiece.type) - EvaluationValues::pieceValues.at(move.piece.type);
-            if (generator.getAttackedSquares()[move.endIndex]){
+            if (info.attackedByThem[move.endIndex]){
                 scoredMove.score += (pieceValueDifference >= 0 ? winningCaptureScore : loosingCaptureScore) + pieceValueDifference;
             }
             else{
@@ -139,6 +176,9 @@ std::vector<Move> preorderMoves(std::vector<Move> const&& moves, Board& board, M
         if (move.promotionType != PieceType::None){
             scoredMove.score += promotionScore + EvaluationValues::pieceValues.at(move.promotionType);
         }
+        else if (history && capturedPiece.type == PieceType::None && !move.isEnPassant){
+            scoredMove.score += history->get(board.getColorToMove(), move);
+        }
     }
 
     std::sort(scoredMoves.rbegin(), scoredMoves.rend());
@@ -151,6 +191,58 @@ std::vector<Move> preorderMoves(std::vector<Move> const&& moves, Board& board, M
     return sortedMoves;
 }
 
+/**
+ * @brief Get the material won by a capture when both sides keep recapturing on its square with their least valuable piece.
+ * 
+ * Either side may stop recapturing when that is better for it. Pins and checks are ignored.
+ * 
+ * @param board the position before the capture
+ * @param move the capture, which has to capture a piece
+ * @return int the material won by the side to move, negative if it loses material
+ */
+static int staticExchangeEvaluation(Board const& board, Move const& move){
+    const Square target = move.endIndex;
+    Bitboard occupied = board.getAllPieceBitboard();
+
+    // gains[i] is the material won by the side making the i-th capture if the exchange stopped afterwards
+    std::array<int, 32> gains;
+    size_t numCaptures = 0;
+    gains[0] = move.isEnPassant ? EvaluationValues::pieceValues.at(PieceType::Pawn) : EvaluationValues::pieceValues.at(board.at(target).type);
+    if (move.isEnPassant) occupied.clearBit(Square(target.getFile(), move.startIndex.getRank()).getIndex64());
+
+    PieceType attackerType = move.piece.type;
+    uint8_t attackerSquare = move.startIndex.getIndex64();
+    PieceColor color = board.getColorToNotMove();
+    while (numCaptures + 1 < gains.size()){
+        numCaptures++;
+        // the piece that just captured is now captured itself
+        gains[numCaptures] = EvaluationValues::pieceValues.at(attackerType) - gains[numCaptures-1];
+
+        occupied.clearBit(attackerSquare);
+        const Bitboard attackers = MoveGenerator::getAttackersTo(board, target, occupied);
+        const Bitboard ownAttackers = attackers & board.getPieceBitboardForOneColor(color);
+        if (!ownAttackers.hasPieces()) break;
+
+        for (auto type : {PieceType::Pawn, PieceType::Knight, PieceType::Bishop, PieceType::Rook, PieceType::Queen, PieceType::King}){
+            const Bitboard candidates = ownAttackers & board.getPieceTypeBitboard(type);
+            if (!candidates.hasPieces()) continue;
+            attackerType = type;
+            attackerSquare = candidates.getLS1B();
+            break;
+        }
+        // the king can't recapture a defended piece
+        if (attackerType == PieceType::King && (attackers & ~ownAttackers).hasPieces()) break;
+
+        color = color == PieceColor::White ? PieceColor::Black : PieceColor::White;
+    }
+
+    // the last entry assumes a capture that never happens, every side picks the better of capturing and stopping
+    while (--numCaptures){
+        gains[numCaptures-1] = -std::max(-gains[numCaptures-1], gains[numCaptures]);
+    }
+    return gains[0];
+}
+
 int getMaterial(PieceColor color, Board const& board){
     int score = 0;
     for (auto type : Utils::allPieceTypes){
@@ -173,13 +265,13 @@ int endgameKingEval(Board const& board, float endgameProgress, PieceColor otherC
     int eval = 0;
 
     if (gameDirection > 0.0f){
-        Coordinate enemyKingPos = Coordinate(board.getBitboard({PieceType::King, otherColor}).getLS1B());
-        int enemyKingDistanceFromCenter = std::max(3 - int(enemyKingPos.x), int(enemyKingPos.x) - 4) + std::max(3 - int(enemyKingPos.y), int(enemyKingPos.y) - 4);
+        Square enemyKingPos = Square(board.getBitboard({PieceType::King, otherColor}).getLS1B());
+        int enemyKingDistanceFromCenter = std::max(3 - int(enemyKingPos.getFile()), int(enemyKingPos.getFile()) - 4) + std::max(3 - int(enemyKingPos.getRank()), int(enemyKingPos.getRank()) - 4);
         eval += enemyKingDistanceFromCenter;
 
         int kingDistance = Utils::manhattanDistance(
-            Coordinate(board.getBitboard({PieceType::King, PieceColor::White}).getLS1B()),
-            Coordinate(board.getBitboard({PieceType::King, PieceColor::Black}).getLS1B())
+            Square(board.getBitboard({PieceType::King, PieceColor::White}).getLS1B()),
+            Square(board.getBitboard({PieceType::King, PieceColor::Black}).getLS1B())
         );
         eval += 14 - kingDistance;
     }
@@ -225,13 +317,11 @@ int evaluate(Board& board, MoveGenerator& generator){
     return eval;
 }
 
-int getSearchExtensionDepth(Move const& lastMove, Board const& board, MoveGenerator& generator){
-    generator.generateAttackData(board);
-
+int getSearchExtensionDepth(Move const& lastMove, Board const& board){
     int searchExtensions = 0;
 
     // extend checks
-    if (generator.isInCheck(board)){
+    if (MoveGenerator::getCheckers(board).hasPieces()){
         searchExtensions++;
     }
 
@@ -243,6 +333,61 @@ int getSearchExtensionDepth(Move const& lastMove, Board const& board, MoveGenera
     return searchExtensions;
 }
 
+/**
+ * @brief The nodes currently searched by any thread, used for ABDADA.
+ * 
+ * Collisions simply overwrite each other, so a node may occasionally not be deferred.
+ */
+class CurrentlySearchingTable{
+    public:
+        // deferring is only worth the overhead close to the root
+        static constexpr int minDeferDepth = 3;
+
+        bool isBeingSearched(uint64_t key) const{
+            return getSlot(key).load(std::memory_order_relaxed) == key;
+        }
+
+        void startSearch(uint64_t key){
+            getSlot(key).store(key, std::memory_order_relaxed);
+        }
+
+        void finishSearch(uint64_t key){
+            uint64_t expected = key;
+            getSlot(key).compare_exchange_strong(expected, 0, std::memory_order_relaxed);
+        }
+
+    private:
+        static constexpr size_t numSlots = 1 << 15;
+
+        std::atomic<uint64_t>& getSlot(uint64_t key) const{
+            return slots[key & (numSlots - 1)];
+        }
+
+        mutable std::vector<std::atomic<uint64_t>> slots = std::vector<std::atomic<uint64_t>>(numSlots);
+};
+
+/**
+ * @brief Add a node to the search tree dump. Only called if it is enabled.
+ * 
+ * @param entryState the state the node was entered with
+ * @param type the type of the node
+ * @param staticEval the static evaluation of the node
+ * @param result the evaluation returned by the node
+ * @param cutoffMoveIndex the number of moves searched before the one causing the cutoff
+ */
+static void dumpNode(NegamaxState const& entryState, SearchTreeDump::Record::NodeType type, int staticEval, int result, int cutoffMoveIndex){
+    SearchTreeDump::Record record;
+    record.alpha = entryState.alpha;
+    record.beta = entryState.beta;
+    record.staticEval = staticEval;
+    record.result = result;
+    record.cutoffMoveIndex = cutoffMoveIndex;
+    record.ply = entryState.ply;
+    record.depth = entryState.depth;
+    record.type = type;
+    SearchTreeDump::write(record);
+}
+
 int capturesOnlyNegamax(Board& board, MoveGenerator& generator, NegamaxState nstate, std::optional<std::chrono::steady_clock::time_point> searchStop, std::atomic<bool> const& searchWasTerminated, SearchResult& searchResult){
     if (searchWasTerminated || searchStop.has_value() && std::chrono::steady_clock::now() >= searchStop.value()) throw SearchStopException();
 
@@ -250,30 +395,107 @@ int capturesOnlyNegamax(Board& board, MoveGenerator& generator, NegamaxState nst
         return 0;
     }
 
+    const NegamaxState entryState = nstate;
     int bestEvaluation = -evalInfinity;
-    if (nstate.negamaxStep(evaluate(board, generator), bestEvaluation))
+    const int staticEval = evaluate(board, generator);
+    if (nstate.negamaxStep(staticEval, bestEvaluation)){
+        if constexpr (isSearchTreeDumpEnabled) dumpNode(entryState, SearchTreeDump::Record::NodeType::Quiescence, staticEval, bestEvaluation, SearchTreeDump::Record::standPatCutoff);
         return bestEvaluation;
+    }
 
     generator.capturesOnly = true;
     auto moves = generator.generateAllMoves(board);
     generator.capturesOnly = false;
-
-    moves = preorderMoves(std::move(moves), board, generator);
-    for (auto move : moves){
-        board.applyMove(move);
-        Utils::ScopeGuard moveRewind_guard([&](){board.rewindMove();});
+    const PositionInfo info = generator.getPositionInfo();
+
+    moves = preorderMoves(std::move(moves), board, info);
+    int cutoffMoveIndex = SearchTreeDump::Record::noCutoff;
+    for (size_t i=0; i<moves.size(); i++){
+        Move const& move = moves.at(i);
+        board.applyMove<searchMoveApplication>(move);
+        Utils::ScopeGuard moveRewind_guard([&](){board.rewindMove<searchMoveApplication>();});
+        if constexpr (isSearchTreeDumpEnabled) SearchTreeDump::setMove(nstate.ply, move.encode());
         int eval = -capturesOnlyNegamax(board, generator, nstate.nextDepth(), searchStop, searchWasTerminated, searchResult);
-        if (nstate.negamaxStep(eval, bestEvaluation))
+        if (nstate.negamaxStep(eval, bestEvaluation)){
+            cutoffMoveIndex = i;
             break;
+        }
     }
 
+    if constexpr (isSearchTreeDumpEnabled) dumpNode(entryState, SearchTreeDump::Record::NodeType::Quiescence, staticEval, bestEvaluation, cutoffMoveIndex);
     return bestEvaluation;
 }
 
-int negamax(Board& board, MoveGenerator& generator, NegamaxState nstate, std::optional<std::chrono::steady_clock::time_point> searchStop, std::atomic<bool> const& searchWasTerminated, TranspositionTable& transpositionTable, SearchResult& searchResult, std::optional<Move>& ponderMove){
+namespace PruningValues{
+// late move pruning searches at most 3 + depth² quiet moves per node
+static constexpr int maxLateMovePruningDepth = 3;
+// quiet moves with a history below -historyPruningMargin * depth are skipped
+static constexpr int maxHistoryPruningDepth = 2;
+static constexpr int historyPruningMargin = 1024;
+// ProbCut searches captures with depth - probCutReduction against beta + probCutMargin
+static constexpr int minProbCutDepth = 5;
+static constexpr int probCutReduction = 4;
+static constexpr int probCutMargin = 200;
+}
+
+int negamax(Board& board, MoveGenerator& generator, NegamaxState nstate, std::optional<std::chrono::steady_clock::time_point> searchStop, std::atomic<bool> const& searchWasTerminated, TranspositionTable& transpositionTable, SearchResult& searchResult, std::optional<Move>& ponderMove, HistoryTable& history, CurrentlySearchingTable* currentlySearching);
+
+/**
+ * @brief Try to prove a beta cutoff with reduced depth searches of good captures.
+ * 
+ * A capture that beats beta by a margin in a shallow search very likely beats beta in the full depth search.
+ * Every capture is first verified with a captures only search, which is much cheaper.
+ * 
+ * @return std::optional<int> the evaluation if a capture failed high
+ */
+static std::optional<int> probCut(Board& board, MoveGenerator& generator, NegamaxState const& nstate, std::vector<Move> const& moves, std::optional<std::chrono::steady_clock::time_point> searchStop, std::atomic<bool> const& searchWasTerminated, TranspositionTable& transpositionTable, SearchResult& searchResult, HistoryTable& history){
+    const int probCutBeta = nstate.beta + PruningValues::probCutMargin;
+    const int staticEval = evaluate(board, generator);
+
+    // a null window just below probCutBeta, so the children only have to prove that they stay below it
+    NegamaxState probCutState{
+        .depth = nstate.depth - PruningValues::probCutReduction + 1,
+        .alpha = probCutBeta - 1,
+        .beta = probCutBeta,
+        .isPVNode = false,
+        .ply = nstate.ply,
+    };
+
+    for (auto const& move : moves){
+        const bool isCapture = move.isEnPassant || board.getAllPieceBitboard().isOccupied(move.endIndex);
+        if (!isCapture) continue;
+        // even winning the exchange doesn't get close to probCutBeta
+        if (staticEval + staticExchangeEvaluation(board, move) < probCutBeta) continue;
+
+        int eval;
+        {
+            board.applyMove<searchMoveApplication>(move);
+            Utils::ScopeGuard moveRewind_guard([&](){board.rewindMove<searchMoveApplication>();});
+            if constexpr (isSearchTreeDumpEnabled) SearchTreeDump::setMove(nstate.ply, move.encode());
+
+            eval = -capturesOnlyNegamax(board, generator, probCutState.nextDepth(), searchStop, searchWasTerminated, searchResult);
+            if (eval >= probCutBeta){
+                std::optional<Move> emptyMove;
+                eval = -negamax(board, generator, probCutState.nextDepth(), searchStop, searchWasTerminated, transpositionTable, searchResult, emptyMove, history, nullptr);
+            }
+        }
+
+        if (eval >= probCutBeta){
+            transpositionTable.addEntry(board, eval, probCutState);
+            return eval;
+        }
+    }
+    return {};
+}
+
+int negamax(Board& board, MoveGenerator& generator, NegamaxState nstate, std::optional<std::chrono::steady_clock::time_point> searchStop, std::atomic<bool> const& searchWasTerminated, TranspositionTable& transpositionTable, SearchResult& searchResult, std::optional<Move>& ponderMove, HistoryTable& history, CurrentlySearchingTable* currentlySearching){
     if (searchWasTerminated || searchStop.has_value() && std::chrono::steady_clock::now() >= searchStop.value()) throw SearchStopException();
 
+    const NegamaxState entryState = nstate;
+    const auto nodeType = nstate.isPVNode ? SearchTreeDump::Record::NodeType::PV : SearchTreeDump::Record::NodeType::NonPV;
+
     if (board.is3FoldRepetition()){
+        if constexpr (isSearchTreeDumpEnabled) dumpNode(entryState, nodeType, 0, 0, SearchTreeDump::Record::repetitionCutoff);
         return 0;
     }
 
@@ -282,20 +504,29 @@ int negamax(Board& board, MoveGenerator& generator, NegamaxState nstate, std::op
         return capturesOnlyNegamax(board, generator, nstate, searchStop, searchWasTerminated, searchResult);
     }
 
-    if (board.is3FoldRepetition()){
-        return 0;
-    }
-
     auto entry = transpositionTable.readPotentialEntry(board, nstate);
-    if (entry.has_value())
+    if (entry.has_value()){
+        if constexpr (isSearchTreeDumpEnabled) dumpNode(entryState, nodeType, 0, entry.value(), SearchTreeDump::Record::ttCutoff);
         return entry.value();
+    }
     
     int bestEvaluation = -evalInfinity;
+    int cutoffMoveIndex = SearchTreeDump::Record::noCutoff;
 
     auto moves = generator.generateAllMoves(board);
+    // the children overwrite the generator's attack data, so everything this node needs is kept here
+    const PositionInfo info = generator.getPositionInfo();
+
+    if (!nstate.isPVNode && !info.isInCheck() && nstate.depth >= PruningValues::minProbCutDepth && std::abs(nstate.beta) < evalInfinity - PruningValues::probCutMargin){
+        const auto probCutEval = probCut(board, generator, nstate, moves, searchStop, searchWasTerminated, transpositionTable, searchResult, history);
+        if (probCutEval.has_value()){
+            if constexpr (isSearchTreeDumpEnabled) dumpNode(entryState, nodeType, evaluate(board, generator), probCutEval.value(), SearchTreeDump::Record::probCutCutoff);
+            return probCutEval.value();
+        }
+    }
 
     if (moves.size() == 0){
-        if (generator.isInCheck(board)){
+        if (info.isInCheck()){
             bestEvaluation = -evalInfinity;
         }
         else{
@@ -303,35 +534,219 @@ int negamax(Board& board, MoveGenerator& generator, NegamaxState nstate, std::op
         }
     }
     else{
-        moves = preorderMoves(std::move(moves), board, generator);
-        for (auto move : moves){
-            board.applyMove(move);
-            Utils::ScopeGuard moveRewind_guard([&](){board.rewindMove();});
+        const bool isDeferringAllowed = currentlySearching && nstate.depth >= CurrentlySearchingTable::minDeferDepth;
+        std::vector<Move> deferredMoves;
+        std::vector<Move> searchedQuietMoves;
+        int numMovesSearched = 0;
+
+        // returns true on a beta cutoff
+        const auto searchMove = [&](Move const& move, bool mayDefer){
+            board.applyMove<searchMoveApplication>(move);
+            Utils::ScopeGuard moveRewind_guard([&](){board.rewindMove<searchMoveApplication>();});
+            // the child probes its bucket after the check for the extensions
+            transpositionTable.prefetch(board.getCurrentHash());
+
+            const uint64_t childKey = board.getCurrentHash();
+            if (mayDefer && currentlySearching->isBeingSearched(childKey)){
+                deferredMoves.push_back(move);
+                return false;
+            }
+            if (isDeferringAllowed) currentlySearching->startSearch(childKey);
+            Utils::ScopeGuard finishSearch_guard([&](){
+                if (isDeferringAllowed) currentlySearching->finishSearch(childKey);
+            });
+            numMovesSearched++;
+            if constexpr (isSearchTreeDumpEnabled) SearchTreeDump::setMove(nstate.ply, move.encode());
 
-            int searchExtensions = getSearchExtensionDepth(move, board, generator);
+            int searchExtensions = getSearchExtensionDepth(move, board);
 
             std::optional<Move> emptyMove;
 
-            int eval = -negamax(board, generator, nstate.nextDepth(searchExtensions), searchStop, searchWasTerminated, transpositionTable, searchResult, emptyMove);
+            NegamaxState childState = nstate.nextDepth(searchExtensions);
+            // only the first move searched continues the principal variation
+            childState.isPVNode = nstate.isPVNode && bestEvaluation == -evalInfinity;
+
+            int eval = -negamax(board, generator, childState, searchStop, searchWasTerminated, transpositionTable, searchResult, emptyMove, history, currentlySearching);
             if (nstate.negamaxStep(eval, bestEvaluation)){
                 if (ponderMove.has_value()){
                     ponderMove.value() = move;
                 }
-                break;
+                return true;
+            }
+            return false;
+        };
+
+        moves = preorderMoves(std::move(moves), board, info, &history);
+
+        // quiet moves late in the move list rarely cause cutoffs at low depth, so they are skipped outside of the principal variation
+        const bool isPruningAllowed = !nstate.isPVNode && !info.isInCheck();
+        const int lateMoveCount = 3 + nstate.depth * nstate.depth;
+
+        bool isCutoff = false;
+        for (size_t i=0; i<moves.size() && !isCutoff; i++){
+            Move const& move = moves.at(i);
+            const bool isQuiet = isQuietMove(move, board);
+
+            // the first move is always searched to establish a bound, so a pruned node can't be mistaken for a mate
+            if (isPruningAllowed && isQuiet && bestEvaluation != -evalInfinity){
+                if (nstate.depth <= PruningValues::maxLateMovePruningDepth && int(searchedQuietMoves.size()) >= lateMoveCount)
+                    continue;
+                if (nstate.depth <= PruningValues::maxHistoryPruningDepth && history.get(board.getColorToMove(), move) < -PruningValues::historyPruningMargin * nstate.depth)
+                    continue;
+            }
+
+            const size_t numDeferredMoves = deferredMoves.size();
+            isCutoff = searchMove(move, isDeferringAllowed && i != 0);
+
+            if (!isQuiet || deferredMoves.size() != numDeferredMoves) continue;
+            if (isCutoff){
+                const int bonus = nstate.depth * nstate.depth;
+                history.update(board.getColorToMove(), move, bonus);
+                for (auto const& quietMove : searchedQuietMoves){
+                    history.update(board.getColorToMove(), quietMove, -bonus);
+                }
+            }
+            else{
+                searchedQuietMoves.push_back(move);
             }
         }
+        for (size_t i=0; i<deferredMoves.size() && !isCutoff; i++){
+            isCutoff = searchMove(deferredMoves.at(i), false);
+        }
+        if (isCutoff) cutoffMoveIndex = numMovesSearched - 1;
     }
 
     transpositionTable.addEntry(board, bestEvaluation, nstate);
 
+    if constexpr (isSearchTreeDumpEnabled) dumpNode(entryState, nodeType, evaluate(board, generator), bestEvaluation, cutoffMoveIndex);
     return bestEvaluation;
 }
 
-SearchResult search(Board& board, MoveGenerator& generator, int depth, std::optional<std::chrono::milliseconds> maxSearchTime, std::atomic<bool> const& searchWasTerminated, std::function<void(SearchResult const&)> iterationEndCallback){
+/**
+ * @brief Search all root moves for one iteration.
+ * 
+ * @param board the position to search
+ * @param generator the move generator
+ * @param result the root moves and statistics, updated with the new evaluations
+ * @param maxEval updated with the best evaluation
+ * @param depth the depth of this iteration
+ * @param searchStop the time at which the search is stopped
+ * @param searchWasTerminated stops the search when set
+ * @param transpositionTable the transposition table
+ * @param history the history table of this thread
+ * @param currentlySearching the table of nodes being searched, if ABDADA is used
+ */
+static void searchRootMoves(Board& board, MoveGenerator& generator, SearchResult& result, int& maxEval, int depth, std::chrono::steady_clock::time_point searchStop, std::atomic<bool> const& searchWasTerminated, TranspositionTable& transpositionTable, HistoryTable& history, CurrentlySearchingTable* currentlySearching){
+    NegamaxState nstate;
+    nstate.alpha = -evalInfinity;
+    nstate.beta = evalInfinity;
+    nstate.depth = depth;
+
+    maxEval = -evalInfinity;
+
+    // sort in reverse to first search the best moves
+    std::sort(result.moves.rbegin(), result.moves.rend());
+    // the evals of all but the best move are mostly bounds, so they are ordered by the effort spent on them in the last iteration instead
+    if (!result.moves.empty()){
+        std::stable_sort(result.moves.begin() + 1, result.moves.end(), [](auto const& a, auto const& b){ return a.nodesSearched > b.nodesSearched; });
+    }
+    for (auto& move : result.moves){
+        const uint64_t nodesBefore = result.nodesSearched;
+        board.applyMove<searchMoveApplication>(move.move);
+        Utils::ScopeGuard moveRewind_guard([&](){board.rewindMove<searchMoveApplication>();});
+        transpositionTable.prefetch(board.getCurrentHash());
+        if constexpr (isSearchTreeDumpEnabled) SearchTreeDump::setMove(nstate.ply, move.move.encode());
+        NegamaxState childState = nstate.nextDepth();
+        childState.isPVNode = maxEval == -evalInfinity;
+        move.eval = -negamax(board, generator, childState, searchStop, searchWasTerminated, transpositionTable, result, move.ponderMove, history, currentlySearching);
+        move.nodesSearched = result.nodesSearched - nodesBefore;
+
+        if (nstate.negamaxStep(move.eval, maxEval))
+            break;
+    }
+}
+
+/**
+ * @brief Run iterative deepening on a helper thread until stopped.
+ * 
+ * The results are only used through the shared transposition table.
+ */
+static void runHelperSearch(Board board, int helperIndex, int depth, ParallelSearchMode mode, std::chrono::steady_clock::time_point searchStop, std::atomic<bool> const& helpersShouldStop, TranspositionTable& transpositionTable, CurrentlySearchingTable* currentlySearching){
+    MoveGenerator generator;
+    HistoryTable history;
+
+    SearchResult result;
+    for (auto move : generator.generateAllMoves(board)){
+        result.moves.emplace_back(move);
+    }
+
+    // with lazy SMP, every second helper searches one ply ahead to diversify the threads
+    const int depthOffset = mode == ParallelSearchMode::LazySMP ? (helperIndex + 1) % 2 : 0;
+    try{
+        for (int currentDepth=1+depthOffset; currentDepth <= depth; currentDepth++){
+            int maxEval;
+            searchRootMoves(board, generator, result, maxEval, currentDepth, searchStop, helpersShouldStop, transpositionTable, history, currentlySearching);
+        }
+    }
+    catch(SearchStopException){}
+    if constexpr (isSearchTreeDumpEnabled) SearchTreeDump::flush();
+}
+
+static float getBestMoveEffort(SearchResult const& result){
+    if (result.moves.empty() || result.nodesSearched == 0) return 0;
+    const auto bestMove = std::max_element(result.moves.begin(), result.moves.end(), [](auto const& a, auto const& b){ return a.eval < b.eval; });
+    return float(bestMove->nodesSearched) / float(result.nodesSearched);
+}
+
+static std::optional<SearchResult> readFromAnalysisCache(AnalysisCache const& analysisCache, Board const& board, std::vector<Move> const& moves, int depth){
+    const auto entry = analysisCache.read(board.getCurrentHash());
+    if (!entry.has_value() || entry->depth < depth || entry->flag != AnalysisCache::Entry::Flag::Exact)
+        return {};
+
+    for (auto const& move : moves){
+        if (move.encode() != entry->move) continue;
+
+        SearchResult result;
+        result.moves.emplace_back(move, entry->eval);
+        result.depthReached = entry->depth;
+        result.maxEval = entry->eval;
+        result.isMate = std::abs(entry->eval) == evalInfinity;
+        return result;
+    }
+    return {};
+}
+
+static void writeToAnalysisCache(AnalysisCache& analysisCache, Board const& board, SearchResult const& result){
+    if (result.depthReached == 0 || result.moves.empty()) return;
+
+    const auto existingEntry = analysisCache.read(board.getCurrentHash());
+    if (existingEntry.has_value() && existingEntry->depth >= result.depthReached) return;
+
+    const auto bestMove = std::max_element(result.moves.begin(), result.moves.end(), [](auto const& a, auto const& b){ return a.eval < b.eval; });
+
+    AnalysisCache::Entry entry;
+    entry.key = board.getCurrentHash();
+    entry.eval = bestMove->eval;
+    entry.depth = result.depthReached;
+    entry.move = bestMove->move.encode();
+    entry.flag = AnalysisCache::Entry::Flag::Exact;
+    analysisCache.write(entry);
+}
+
+SearchResult search(Board& board, MoveGenerator& generator, TranspositionTable& transpositionTable, int depth, std::optional<std::chrono::milliseconds> maxSearchTime, std::atomic<bool> const& searchWasTerminated, std::function<void(SearchResult const&)> iterationEndCallback, AnalysisCache* analysisCache, ThreadPool* helperPool, ParallelSearchMode parallelSearchMode){
     if (depth == 0) throw std::invalid_argument("Depth may not be 0");
 
+    transpositionTable.newSearch();
     auto moves = generator.generateAllMoves(board);
 
+    if (analysisCache && moves.size() > 1){
+        auto cachedResult = readFromAnalysisCache(*analysisCache, board, moves, depth);
+        if (cachedResult.has_value()){
+            iterationEndCallback(cachedResult.value());
+            return cachedResult.value();
+        }
+    }
+
 
     // move preordering
     SearchResult result;
@@ -346,6 +761,10 @@ SearchResult search(Board& board, MoveGenerator& generator, int depth, std::opti
         return result;
     }
     SearchResult resultTmp = result;
+    // stores the deepest completed iteration
+    const auto storeInAnalysisCache = [&](){
+        if (analysisCache) writeToAnalysisCache(*analysisCache, board, result);
+    };
 
     std::chrono::steady_clock::time_point searchStopTP;
     if (maxSearchTime.has_value()){
@@ -355,33 +774,41 @@ SearchResult search(Board& board, MoveGenerator& generator, int depth, std::opti
         searchStopTP = std::chrono::steady_clock::time_point::max();
     }
 
-    TranspositionTable transpositionTable;
+    // start the helper threads. They run until this search returns.
+    std::optional<CurrentlySearchingTable> currentlySearching;
+    if (helperPool && parallelSearchMode == ParallelSearchMode::ABDADA){
+        currentlySearching.emplace();
+    }
+    CurrentlySearchingTable* const currentlySearchingPtr = currentlySearching.has_value() ? &currentlySearching.value() : nullptr;
+    std::atomic<bool> helpersShouldStop = false;
+    if (helperPool){
+        helperPool->submitToAll([&, helperBoard = board](int workerIndex){
+            runHelperSearch(helperBoard, workerIndex, depth, parallelSearchMode, searchStopTP, helpersShouldStop, transpositionTable, currentlySearchingPtr);
+        });
+    }
+    Utils::ScopeGuard stopHelpers_guard([&](){
+        if (!helperPool) return;
+        helpersShouldStop = true;
+        helperPool->wait();
+    });
+
+    // the records of the main thread are written once the search returns
+    Utils::ScopeGuard flushSearchTreeDump_guard([](){
+        if constexpr (isSearchTreeDumpEnabled) SearchTreeDump::flush();
+    });
 
     // iterative deepening
+    HistoryTable history;
     for (int currentDepth=1; currentDepth <= depth; currentDepth++){
-        NegamaxState nstate;
-        nstate.alpha = -evalInfinity;
-        nstate.beta = evalInfinity;
-        nstate.depth = currentDepth;
-
-        result.maxEval = -evalInfinity;
-
-        // sort in reverse to first search the best moves
-        std::sort(resultTmp.moves.rbegin(), resultTmp.moves.rend());
         try{
-            for (auto& move : resultTmp.moves){
-                board.applyMove(move.move);
-                Utils::ScopeGuard moveRewind_guard([&](){board.rewindMove();});
-                move.eval = -negamax(board, generator, nstate.nextDepth(), searchStopTP, searchWasTerminated, transpositionTable, resultTmp, move.ponderMove);
-
-                if (nstate.negamaxStep(move.eval, result.maxEval))
-                    break;
-            }
+            searchRootMoves(board, generator, resultTmp, resultTmp.maxEval, currentDepth, searchStopTP, searchWasTerminated, transpositionTable, history, currentlySearchingPtr);
         }
         catch(SearchStopException){
+            storeInAnalysisCache();
             return resultTmp;
         }
         resultTmp.depthReached = currentDepth;
+        resultTmp.bestMoveEffort = getBestMoveEffort(resultTmp);
         result = resultTmp;
         resultTmp.nodesSearched = 0;
         result.isMate = std::abs(result.maxEval) == evalInfinity;
@@ -390,10 +817,12 @@ SearchResult search(Board& board, MoveGenerator& generator, int depth, std::opti
 
         // exit early if a checkmate is found
         if (result.isMate){
+            storeInAnalysisCache();
             return result;
         }
     }
 
+    storeInAnalysisCache();
     return result;
 }
 
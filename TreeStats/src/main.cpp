@@ -0,0 +1,176 @@
+#include "Thera/SearchTreeDump.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <array>
+#include <map>
+#include <vector>
+#include <stdexcept>
+
+using Record = Thera::SearchTreeDump::Record;
+
+struct Options{
+    std::string path;
+    int maxIndex = 8;
+};
+
+// statistics of all nodes with the same type and depth
+struct NodeStatistics{
+    uint64_t numNodes = 0;
+    uint64_t numFailHigh = 0;
+    uint64_t numFailLow = 0;
+    uint64_t numProbCutCutoffs = 0;
+    uint64_t numStandPatCutoffs = 0;
+    uint64_t numTTCutoffs = 0;
+    uint64_t numRepetitions = 0;
+    // the last entry counts all cutoffs at maxIndex or later
+    std::vector<uint64_t> cutoffsByIndex;
+};
+
+void printHelp(std::string const& argv0){
+    std::cout << "Usage: " << argv0 << " [options] [dump file]\n" <<
+R"(Prints statistics about a search tree dump written by a build with THERA_SEARCH_TREE_DUMP.
+
+Options:
+    -h/--help               Print this helping text
+    --max-index [n]         Cutoffs at this move index or later share the last column (default: 8)
+)";
+}
+
+static std::string getNodeTypeName(Record::NodeType type){
+    switch (type){
+        case Record::NodeType::PV:
+            return "PV";
+        case Record::NodeType::NonPV:
+            return "NonPV";
+        case Record::NodeType::Quiescence:
+            return "QS";
+    }
+    throw std::invalid_argument("Unknown node type " + std::to_string(int(type)));
+}
+
+static std::string formatPercentage(uint64_t part, uint64_t total){
+    if (total == 0) return "-";
+    std::stringstream stream;
+    stream << std::fixed << std::setprecision(1) << 100.0 * part / total << "%";
+    return stream.str();
+}
+
+static std::map<std::pair<Record::NodeType, int>, NodeStatistics> readStatistics(Options const& options){
+    std::ifstream file(options.path, std::ios::binary);
+    if (!file.is_open()) throw std::runtime_error("Could not open \"" + options.path + "\"");
+
+    std::map<std::pair<Record::NodeType, int>, NodeStatistics> statistics;
+    Record record;
+    while (file.read(reinterpret_cast<char*>(&record), sizeof(Record))){
+        // quiescence depths are negative, but their histogram is only interesting as a whole
+        const int depth = record.type == Record::NodeType::Quiescence ? 0 : record.depth;
+        auto& stats = statistics[{record.type, depth}];
+        if (stats.cutoffsByIndex.empty()) stats.cutoffsByIndex.resize(options.maxIndex + 1, 0);
+
+        stats.numNodes++;
+        // a node cuts off once alpha exceeds beta
+        if (record.result > record.beta) stats.numFailHigh++;
+        else if (record.result <= record.alpha) stats.numFailLow++;
+
+        if (record.cutoffMoveIndex == Record::probCutCutoff){
+            stats.numProbCutCutoffs++;
+        }
+        else if (record.cutoffMoveIndex == Record::standPatCutoff){
+            stats.numStandPatCutoffs++;
+        }
+        else if (record.cutoffMoveIndex == Record::ttCutoff){
+            stats.numTTCutoffs++;
+        }
+        else if (record.cutoffMoveIndex == Record::repetitionCutoff){
+            stats.numRepetitions++;
+        }
+        else if (record.cutoffMoveIndex >= 0){
+            stats.cutoffsByIndex.at(std::min<int>(record.cutoffMoveIndex, options.maxIndex))++;
+        }
+    }
+    if (file.gcount() != 0) throw std::runtime_error("The dump ends with a partial record");
+
+    return statistics;
+}
+
+static void printStatistics(Options const& options, std::map<std::pair<Record::NodeType, int>, NodeStatistics> const& statistics){
+    std::cout << std::setw(6) << "type" << std::setw(6) << "depth" << std::setw(12) << "nodes"
+        << std::setw(8) << "high" << std::setw(8) << "low" << std::setw(8) << "pc" << std::setw(8) << "sp"
+        << std::setw(8) << "tt" << std::setw(8) << "rep";
+    for (int index=0; index<=options.maxIndex; index++){
+        std::cout << std::setw(8) << (index == options.maxIndex ? std::to_string(index) + "+" : std::to_string(index));
+    }
+    std::cout << "\n";
+
+    for (auto const& [key, stats] : statistics){
+        const auto [type, depth] = key;
+        uint64_t numCutoffs = 0;
+        for (auto count : stats.cutoffsByIndex) numCutoffs += count;
+
+        std::cout << std::setw(6) << getNodeTypeName(type) << std::setw(6) << (type == Record::NodeType::Quiescence ? "*" : std::to_string(depth))
+            << std::setw(12) << stats.numNodes
+            << std::setw(8) << formatPercentage(stats.numFailHigh, stats.numNodes)
+            << std::setw(8) << formatPercentage(stats.numFailLow, stats.numNodes)
+            << std::setw(8) << formatPercentage(stats.numProbCutCutoffs, stats.numNodes)
+            << std::setw(8) << formatPercentage(stats.numStandPatCutoffs, stats.numNodes)
+            << std::setw(8) << formatPercentage(stats.numTTCutoffs, stats.numNodes)
+            << std::setw(8) << formatPercentage(stats.numRepetitions, stats.numNodes);
+        for (auto count : stats.cutoffsByIndex){
+            std::cout << std::setw(8) << formatPercentage(count, numCutoffs);
+        }
+        std::cout << "\n";
+    }
+
+    std::cout << "\nhigh/low: nodes failing high/low, pc: ProbCut cutoffs, sp: stand pat cutoffs, tt: transposition table hits, rep: repetitions\n";
+    std::cout << "The remaining columns are the share of move cutoffs by the index of the move in the searched order.\n";
+}
+
+int main(int argc, const char** argv){
+    Options options;
+
+    int i = 0;
+    while (i+1 < argc){
+        std::string arg = argv[++i];
+        const auto nextArgument = [&]() -> std::string{
+            if (i+1 >= argc) throw std::invalid_argument("Missing value for \"" + arg + "\" option");
+            return argv[++i];
+        };
+
+        try{
+            if (arg == "-h" || arg == "--help"){
+                printHelp(argv[0]);
+                return 0;
+            }
+            else if (arg == "--max-index"){
+                options.maxIndex = std::stoi(nextArgument());
+                if (options.maxIndex < 1) throw std::invalid_argument("The max index has to be at least 1");
+            }
+            else{
+                options.path = arg;
+            }
+        }
+        catch(std::exception const& e){
+            std::cout << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    if (options.path.empty()){
+        printHelp(argv[0]);
+        return 1;
+    }
+
+    try{
+        printStatistics(options, readStatistics(options));
+    }
+    catch(std::exception const& e){
+        std::cout << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -2,7 +2,14 @@
 #include "Thera/Utils/ChessTerms.hpp"
 #include "Thera/MoveGenerator.hpp"
 #include "Thera/search.hpp"
+#include "Thera/AnalysisCache.hpp"
+#include "Thera/TranspositionTable.hpp"
 #include "Thera/Utils/GitInfo.hpp"
+#include "Thera/Utils/Topology.hpp"
+#include "Thera/ThreadPool.hpp"
+#include "Thera/ClusterNode.hpp"
+#include "Thera/OpeningBook.hpp"
+#include "Thera/SearchTreeDump.hpp"
 
 #include "TheraUCI/MultiStream.hpp"
 #include "TheraUCI/stringUtils.hpp"
@@ -15,7 +22,7 @@
 #include <chrono>
 #include <atomic>
 #include <thread>
-#include <condition_variable>
+#include <optional>
 
 static MultiStream out;
 static std::ofstream logfile;
@@ -46,45 +53,104 @@ constexpr int infiniteDepth = 9999;
 
 static Thera::Board board;
 static Thera::MoveGenerator generator;
-
-static std::condition_variable searchStartCond;
-static std::mutex searchStartMutex;
+static Thera::AnalysisCache analysisCache;
+static Thera::OpeningBook openingBook;
+static Thera::TranspositionTable transpositionTable;
+static Thera::ClusterNode cluster(transpositionTable);
 
 static std::atomic<bool> searchShouldStop = false;
-static std::atomic<bool> searchThreadShouldExit = false;
+static std::atomic<bool> searchIsSilent = false;
 static struct SearchParameters{
     std::optional<std::chrono::milliseconds> maxSearchTime;
+    // when playing on a clock, no new iteration is started after this time, scaled by the effort spent on the best move
+    std::optional<std::chrono::milliseconds> optimumSearchTime;
     int depth = infiniteDepth;
-    bool silent = false;
+    // helper threads in addition to the main search thread
+    Thera::ThreadPool* helperPool = nullptr;
+    Thera::ParallelSearchMode parallelSearchMode = Thera::ParallelSearchMode::LazySMP;
 } searchParameters;
 
-void searchThreadFunction(){
-    while (!searchThreadShouldExit){
-        std::unique_lock lock(searchStartMutex);
-        searchStartCond.wait(lock);
-        if (searchThreadShouldExit){
-            return;
-        }
+void publishIterationResult(Thera::SearchResult const& result){
+    const auto bestMove = std::max_element(result.moves.begin(), result.moves.end(), [](auto const& a, auto const& b){ return a.eval < b.eval; });
+    if (bestMove == result.moves.end()) return;
 
-        search_start = std::chrono::high_resolution_clock::now();
-        auto moves = Thera::search(board, generator, searchParameters.depth, searchParameters.maxSearchTime, searchShouldStop, iterationEndCallback);
-        const auto end = std::chrono::high_resolution_clock::now();
+    Thera::ClusterNode::RootResult rootResult;
+    rootResult.key = board.getCurrentHash();
+    rootResult.depth = result.depthReached;
+    rootResult.eval = bestMove->eval;
+    rootResult.move = bestMove->move.encode();
+    cluster.publishRootResult(rootResult);
+}
 
-        auto bestMove = getRandomBestMove(moves);
-        std::chrono::duration<double> dur = end-search_start;
-        if (searchParameters.silent){
-            continue;
-        }
+// use the move of another cluster process if it searched deeper
+void applyDeeperClusterResult(Thera::SearchResult const& result, Thera::EvaluatedMove& bestMove){
+    const auto clusterResult = cluster.getDeepestRootResult(board.getCurrentHash());
+    if (!clusterResult.has_value() || clusterResult->depth <= result.depthReached) return;
+
+    for (auto const& move : result.moves){
+        if (move.move.encode() != clusterResult->move) continue;
+
+        bestMove = move;
+        bestMove.eval = clusterResult->eval;
+        bestMove.ponderMove.reset();
+        logfile << "Using depth " << clusterResult->depth << " result from the cluster.\n";
+        return;
+    }
+}
+
+// picks a move of the opening book with a probability proportional to its weight
+std::optional<Thera::Move> getBookMove(){
+    if (!openingBook.isOpen()) return {};
 
-        out << "bestmove " << bestMove.move.toString();
-        if (bestMove.ponderMove.has_value()){
-            out << " ponder " << bestMove.ponderMove.value().toString();
+    const auto moves = openingBook.getMoves(board, generator);
+    uint32_t totalWeight = 0;
+    for (auto const& move : moves){
+        totalWeight += move.weight;
+    }
+    if (totalWeight == 0) return {};
+
+    uint32_t selectedWeight = rand() % totalWeight;
+    for (auto const& move : moves){
+        if (selectedWeight < move.weight) return move.move;
+        selectedWeight -= move.weight;
+    }
+    return {};
+}
+
+void runSearch(SearchParameters parameters){
+    const auto callback = [&](Thera::SearchResult const& result){
+        if (cluster.isOpen()) publishIterationResult(result);
+        iterationEndCallback(result);
+
+        if (parameters.optimumSearchTime.has_value()){
+            // an uncertain best move gets up to 1.5 times the optimum, a clear one only half of it
+            const auto scaledOptimum = std::chrono::duration<double, std::milli>(parameters.optimumSearchTime.value()) * (1.5 - result.bestMoveEffort);
+            if (std::chrono::high_resolution_clock::now() - search_start >= scaledOptimum){
+                logfile << "Stopping after depth " << result.depthReached << " with a best move effort of " << result.bestMoveEffort << ".\n";
+                searchShouldStop = true;
+            }
         }
-        out << "\n";
-        out.flush();
-        std::cout.flush();
-        logfile << "Search took " << dur.count() << "s.\n";
+    };
+
+    search_start = std::chrono::high_resolution_clock::now();
+    auto moves = Thera::search(board, generator, transpositionTable, parameters.depth, parameters.maxSearchTime, searchShouldStop, callback, analysisCache.isOpen() ? &analysisCache : nullptr, parameters.helperPool, parameters.parallelSearchMode);
+    const auto end = std::chrono::high_resolution_clock::now();
+
+    auto bestMove = getRandomBestMove(moves);
+    if (cluster.isOpen()) applyDeeperClusterResult(moves, bestMove);
+    std::chrono::duration<double> dur = end-search_start;
+    if (searchIsSilent){
+        return;
+    }
+
+    out << "bestmove " << bestMove.move.toString();
+    if (bestMove.ponderMove.has_value()){
+        out << " ponder " << bestMove.ponderMove.value().toString();
     }
+    out << "\n";
+    out.flush();
+    std::cout.flush();
+    logfile << "Search took " << dur.count() << "s.\n";
 }
 
 int main(){
@@ -92,7 +158,9 @@ int main(){
     std::stringstream lineStream;
     std::string buffer;
 
-    std::thread searchThread(searchThreadFunction);
+    // the helpers have to outlive the search using them
+    Thera::ThreadPool helperPool(1);
+    Thera::ThreadPool searchPool(1);
 
     logfile.open("/tmp/TheraUCI.log");
     if (!logfile.is_open()){
@@ -122,9 +190,62 @@ int main(){
     out << "id name Thera (Git " + version + ")\n";
     out << "id author Robotino\n";
 
+    // send options
+    out << "option name Hash type spin default " << Thera::TranspositionTable::defaultSizeMB << " min 1 max 131072\n";
+    out << "option name Hash Prefault type check default true\n";
+    out << "option name Shared Hash type string default <empty>\n";
+    out << "option name Clear Hash type button\n";
+    out << "option name Threads type spin default 1 min 1 max 1024\n";
+    out << "option name Parallel Search type combo default Lazy SMP var Lazy SMP var ABDADA\n";
+    out << "option name NUMA type check default false\n";
+    out << "option name AnalysisCache type string default <empty>\n";
+    out << "option name Book type string default <empty>\n";
+    out << "option name Cluster type string default <empty>\n";
+    out << "option name Cluster Min Depth type spin default " << Thera::ClusterNode::defaultMinSharedDepth << " min 1 max 64\n";
+    if constexpr (Thera::isSearchTreeDumpEnabled){
+        out << "option name SearchTreeDump type string default <empty>\n";
+    }
+
     out << "uciok\n";
 
     int numMoves;
+    size_t hashSizeMB = Thera::TranspositionTable::defaultSizeMB;
+    bool prefaultHash = true;
+    bool useNuma = false;
+    int numThreads = 1;
+    std::string clusterDirectory;
+    int clusterMinDepth = Thera::ClusterNode::defaultMinSharedDepth;
+    const auto openCluster = [&](){
+        try{
+            if (clusterDirectory.empty()) cluster.close();
+            else cluster.open(clusterDirectory, clusterMinDepth);
+        }
+        catch (std::exception const& e){
+            logfile << e.what() << "\n";
+        }
+    };
+    // a POSIX shared memory name or file backing the table, so it is shared with other processes
+    std::string sharedHashName;
+    const auto reallocateTable = [&](){
+        cluster.close();
+        try{
+            if (sharedHashName.empty()) transpositionTable.resize(hashSizeMB, prefaultHash, useNuma);
+            else transpositionTable.openShared(sharedHashName, hashSizeMB);
+        }
+        catch (std::runtime_error const& e){
+            logfile << e.what() << "\n";
+        }
+        openCluster();
+    };
+
+    const auto numaTopology = Thera::Utils::getNumaTopology();
+
+    const auto stopSearch = [&](){
+        if (searchPool.isBusy()){
+            searchShouldStop = true;
+            searchPool.wait();
+        }
+    };
 
     while (true){
         out.flush();
@@ -137,6 +258,8 @@ int main(){
         
         lineStream >> buffer;
         if (buffer == "position"){
+            // the search works on the shared board
+            stopSearch();
             lineStream >> buffer;
             if (buffer == "startpos"){
                 board.loadFromFEN(Thera::Utils::startingFEN);
@@ -194,20 +317,108 @@ int main(){
             // log the resulting position
             logfile << board.storeToFEN() << "\n";
         }
+        else if (buffer == "setoption"){
+            // options like the thread count can't change during a search
+            stopSearch();
+            std::string name, value;
+            lineStream >> buffer;
+            if (buffer != "name"){
+                logfile << "Invalid syntax for 'setoption'\n";
+                continue;
+            }
+            // names and values may contain spaces
+            while (lineStream >> buffer && buffer != "value"){
+                name += (name.empty() ? "" : " ") + buffer;
+            }
+            while (lineStream >> buffer){
+                value += (value.empty() ? "" : " ") + buffer;
+            }
+
+            if (name == "Hash"){
+                hashSizeMB = std::stoul(value);
+                reallocateTable();
+            }
+            else if (name == "Hash Prefault"){
+                prefaultHash = value == "true";
+            }
+            else if (name == "Shared Hash"){
+                sharedHashName = value == "<empty>" ? "" : value;
+                reallocateTable();
+            }
+            else if (name == "Threads"){
+                numThreads = std::max(1, std::stoi(value));
+                helperPool.resize(std::max(1, numThreads-1), useNuma);
+                searchParameters.helperPool = numThreads > 1 ? &helperPool : nullptr;
+            }
+            else if (name == "Parallel Search"){
+                if (value == "ABDADA") searchParameters.parallelSearchMode = Thera::ParallelSearchMode::ABDADA;
+                else searchParameters.parallelSearchMode = Thera::ParallelSearchMode::LazySMP;
+            }
+            else if (name == "NUMA"){
+                useNuma = value == "true";
+                reallocateTable();
+                searchPool.resize(searchPool.getNumThreads(), useNuma);
+                helperPool.resize(helperPool.getNumThreads(), useNuma);
+                logfile << "Using " << numaTopology.size() << " NUMA node(s).\n";
+            }
+            else if (name == "Clear Hash"){
+                transpositionTable.clear(std::thread::hardware_concurrency());
+            }
+            else if (name == "Cluster"){
+                clusterDirectory = value == "<empty>" ? "" : value;
+                openCluster();
+            }
+            else if (name == "Cluster Min Depth"){
+                clusterMinDepth = std::stoi(value);
+                if (cluster.isOpen()) openCluster();
+            }
+            else if (name == "Book"){
+                try{
+                    if (value.empty() || value == "<empty>") openingBook.close();
+                    else openingBook.open(value);
+                }
+                catch (std::runtime_error const& e){
+                    logfile << e.what() << "\n";
+                }
+            }
+            else if (name == "AnalysisCache"){
+                try{
+                    if (value.empty() || value == "<empty>") analysisCache.close();
+                    else analysisCache.open(value);
+                }
+                catch (std::runtime_error const& e){
+                    logfile << e.what() << "\n";
+                }
+            }
+            else if (Thera::isSearchTreeDumpEnabled && name == "SearchTreeDump"){
+                try{
+                    if (value.empty() || value == "<empty>") Thera::SearchTreeDump::close();
+                    else Thera::SearchTreeDump::open(value);
+                }
+                catch (std::runtime_error const& e){
+                    logfile << e.what() << "\n";
+                }
+            }
+            else{
+                logfile << "Unknown option '" + name + "'\n";
+            }
+        }
+        else if (buffer == "ucinewgame"){
+            // entries of the old game only fill the table, but a shared table is still used by the other processes
+            stopSearch();
+            if (!transpositionTable.isShared()) transpositionTable.clear(std::thread::hardware_concurrency());
+        }
         else if (buffer == "isready"){
             out << "readyok\n";
         }
         else if (buffer == "quit"){
-            searchParameters.silent = true;
-            searchShouldStop = true;            
-            searchThreadShouldExit = true;
-            searchStartCond.notify_one();
-            searchThread.join();
+            searchIsSilent = true;
+            searchShouldStop = true;
+            searchPool.wait();
             return 0;
         }
         else if (buffer == "stop"){
-            searchShouldStop = true;            
-            searchStartCond.notify_one();
+            searchShouldStop = true;
         }
         else if (buffer == "go"){
             std::chrono::milliseconds wtime = std::chrono::milliseconds::zero();
@@ -216,6 +427,8 @@ int main(){
             std::chrono::milliseconds binc = std::chrono::milliseconds::zero();
             std::optional<std::chrono::milliseconds> movetime;
             searchParameters.depth = infiniteDepth;
+            searchParameters.maxSearchTime.reset();
+            searchParameters.optimumSearchTime.reset();
             while (lineStream.rdbuf()->in_avail()){
                 lineStream >> buffer;
                 if (buffer == "wtime"){
@@ -251,16 +464,25 @@ int main(){
                 // assume a game lasts max. 60 moves.
                 int movesLeft = 80*2-numMoves;
                 auto maxTimePerMoveLeft = std::max(time / movesLeft, std::chrono::milliseconds(10));
-                searchParameters.maxSearchTime = inc + maxTimePerMoveLeft;
-                logfile << "Searching for " << searchParameters.maxSearchTime.value().count() << "ms.\n"; 
+                searchParameters.optimumSearchTime = inc + maxTimePerMoveLeft;
+                // iterations that started before the scaled optimum may run longer, but never use more than a quarter of the remaining time
+                searchParameters.maxSearchTime = std::max(std::min(2 * searchParameters.optimumSearchTime.value(), inc + time / 4), searchParameters.optimumSearchTime.value());
+                logfile << "Searching for " << searchParameters.optimumSearchTime.value().count() << "ms, at most " << searchParameters.maxSearchTime.value().count() << "ms.\n"; 
             }
             if (searchParameters.depth < infiniteDepth){
                 logfile << "Searching to depth " << searchParameters.depth << ".\n"; 
             }
-            searchParameters.silent = false;
-
+            // only one search may run at a time
+            stopSearch();
+            const auto bookMove = getBookMove();
+            if (bookMove.has_value()){
+                logfile << "Playing a book move.\n";
+                out << "bestmove " << bookMove.value().toString() << "\n";
+                continue;
+            }
+            searchIsSilent = false;
             searchShouldStop = false;
-            searchStartCond.notify_one();
+            searchPool.submit([parameters = searchParameters](int){ runSearch(parameters); });
         }
 
         if (lineStream.rdbuf()->in_avail()){
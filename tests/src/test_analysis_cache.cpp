@@ -0,0 +1,80 @@
+#include "Thera/AnalysisCache.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <stdexcept>
+#include <filesystem>
+
+#include <unistd.h>
+
+static int expectEntry(Thera::AnalysisCache const& cache, uint64_t key, int expectedEval, int expectedDepth, std::string const& situation){
+    const auto entry = cache.read(key);
+    if (!entry.has_value() || entry->eval != expectedEval || entry->depth != expectedDepth){
+        std::cout << "Wrong entry for key " << key << " " << situation << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+int main(){
+    const std::string path = (std::filesystem::temp_directory_path() / ("thera-test-analysis-cache-" + std::to_string(getpid()))).string();
+    int failures = 0;
+
+    try{
+        Thera::AnalysisCache cache;
+        cache.open(path);
+        cache.write({.key = 1, .eval = 10, .depth = 5, .move = 100});
+        cache.write({.key = 2, .eval = -20, .depth = 7, .move = 200, .flag = Thera::AnalysisCache::Entry::Flag::LowerBound});
+        // a shallower result must not replace a deeper one
+        cache.write({.key = 2, .eval = 30, .depth = 3, .move = 300});
+        failures += expectEntry(cache, 1, 10, 5, "after writing");
+        failures += expectEntry(cache, 2, -20, 7, "after writing");
+        if (cache.read(3).has_value()){
+            std::cout << "Found an entry that was never written\n";
+            failures++;
+        }
+
+        // only one user at a time
+        Thera::AnalysisCache other;
+        try{
+            other.open(path);
+            std::cout << "A locked cache could be opened\n";
+            failures++;
+        }
+        catch(std::runtime_error const&){}
+
+        cache.close();
+        cache.open(path);
+        failures += expectEntry(cache, 1, 10, 5, "after reopening");
+        failures += expectEntry(cache, 2, -20, 7, "after reopening");
+        cache.close();
+
+        // a crash while appending leaves a partial record, which is dropped on opening
+        {
+            std::ofstream log(path + ".log", std::ios::binary | std::ios::app);
+            log << "partial";
+        }
+        cache.open(path);
+        failures += expectEntry(cache, 1, 10, 5, "after repairing the log");
+        cache.write({.key = 3, .eval = 1, .depth = 1});
+        failures += expectEntry(cache, 3, 1, 1, "written after repairing the log");
+        cache.close();
+
+        // a missing index is rebuilt from the log
+        std::filesystem::remove(path + ".idx");
+        cache.open(path);
+        failures += expectEntry(cache, 2, -20, 7, "after rebuilding the index");
+        failures += expectEntry(cache, 3, 1, 1, "after rebuilding the index");
+        cache.close();
+    }
+    catch(std::exception const& e){
+        std::cout << e.what() << "\n";
+        failures++;
+    }
+    std::filesystem::remove(path + ".log");
+    std::filesystem::remove(path + ".idx");
+
+    std::cout << (failures == 0 ? "All analysis cache tests passed ✓" : std::to_string(failures) + " analysis cache tests failed ✗") << "\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,63 @@
+#include "Thera/Board.hpp"
+#include "Thera/Move.hpp"
+#include "Thera/MoveGenerator.hpp"
+
+#include "Thera/Utils/ScopeGuard.hpp"
+#include "Thera/Utils/ChessTerms.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+// compare the incrementally updated tables against a fresh computation
+static int compareWithRefresh(Thera::Board const& board){
+    Thera::Board reference = board;
+    reference.refreshAttackTables();
+
+    for (int square=0; square<64; square++){
+        const Thera::Square sq = Thera::Square(static_cast<uint8_t>(square));
+        if (uint64_t(board.getAttacksFrom(sq)) != uint64_t(reference.getAttacksFrom(sq)) || uint64_t(board.getAttacksTo(sq)) != uint64_t(reference.getAttacksTo(sq))){
+            std::cout << "Attack tables differ on " << Thera::Utils::squareToAlgebraicNotation(sq) << " in " << board.storeToFEN() << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int testTree(Thera::Board& board, Thera::MoveGenerator& generator, int depth){
+    int failures = compareWithRefresh(board);
+    if (depth == 0 || failures) return failures;
+
+    for (auto const& move : generator.generateAllMoves(board)){
+        board.applyMove(move);
+        Thera::Utils::ScopeGuard moveRewind_guard([&](){board.rewindMove();});
+        failures += testTree(board, generator, depth-1);
+        if (failures) break;
+    }
+    // rewinding has to restore the tables as well
+    return failures + compareWithRefresh(board);
+}
+
+int main(){
+    const std::vector<std::string> fens = {
+        Thera::Utils::startingFEN,
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        "8/8/3k4/8/3Pp3/8/8/3Q3K b - d3 0 1",
+    };
+
+    int failures = 0;
+
+    Thera::Board board;
+    Thera::MoveGenerator generator;
+    board.setAttackTracking(true);
+    for (auto const& fen : fens){
+        board.loadFromFEN(fen);
+        failures += testTree(board, generator, 3);
+    }
+
+    std::cout << (failures == 0 ? "All attack table tests passed ✓" : std::to_string(failures) + " attack table tests failed ✗") << "\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,99 @@
+#include "Thera/Board.hpp"
+#include "Thera/ClusterNode.hpp"
+#include "Thera/TranspositionTable.hpp"
+#include "Thera/search.hpp"
+
+#include "Thera/Utils/ChessTerms.hpp"
+
+#include <iostream>
+#include <string>
+#include <stdexcept>
+#include <filesystem>
+#include <thread>
+#include <chrono>
+
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+
+static constexpr auto timeout = std::chrono::seconds(10);
+
+// stores deep entries and publishes a deep root result until it is killed
+static void runPeer(std::string const& directory, uint64_t rootKey){
+    Thera::TranspositionTable table(1);
+    Thera::ClusterNode node(table);
+    node.open(directory);
+
+    Thera::Board board;
+    board.loadFromFEN(Thera::Utils::startingFEN);
+    const auto start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - start < timeout){
+        table.addEntry(board, 42, Thera::NegamaxState{.depth = 6, .alpha = -100, .beta = 100});
+        node.publishRootResult({.key = rootKey, .depth = 9, .eval = 42, .move = 1});
+        std::this_thread::sleep_for(Thera::ClusterNode::exchangeInterval);
+    }
+}
+
+// the nodes are named after the process id, so the peer has to be a separate process
+int main(){
+    const std::string directory = (std::filesystem::temp_directory_path() / ("thera-test-cluster-" + std::to_string(getpid()))).string();
+    const uint64_t rootKey = 0x1234;
+    std::filesystem::create_directories(directory);
+
+    const pid_t peer = fork();
+    if (peer == -1){
+        std::cout << "Unable to start the peer process\n";
+        return 1;
+    }
+    if (peer == 0){
+        try{
+            runPeer(directory, rootKey);
+        }
+        catch(std::exception const& e){
+            std::cout << "Peer: " << e.what() << "\n";
+        }
+        _exit(0);
+    }
+
+    int failures = 0;
+    try{
+        Thera::TranspositionTable table(1);
+        Thera::ClusterNode node(table);
+        node.open(directory);
+        node.publishRootResult({.key = rootKey, .depth = 3, .eval = 0, .move = 2});
+
+        const auto start = std::chrono::steady_clock::now();
+        while ((node.getNumReceivedEntries() == 0 || node.getDeepestRootResult(rootKey)->depth != 9) && std::chrono::steady_clock::now() - start < timeout){
+            std::this_thread::sleep_for(Thera::ClusterNode::exchangeInterval);
+        }
+
+        if (node.getNumReceivedEntries() == 0){
+            std::cout << "No entries were received\n";
+            failures++;
+        }
+        const auto result = node.getDeepestRootResult(rootKey);
+        if (!result.has_value() || result->depth != 9 || result->eval != 42 || result->move != 1){
+            std::cout << "The deeper root result of the peer wasn't received\n";
+            failures++;
+        }
+
+        Thera::Board board;
+        board.loadFromFEN(Thera::Utils::startingFEN);
+        Thera::NegamaxState nstate{.depth = 6, .alpha = -1000, .beta = 1000};
+        if (table.readPotentialEntry(board, nstate) != 42){
+            std::cout << "The received entry wasn't stored in the table\n";
+            failures++;
+        }
+    }
+    catch(std::exception const& e){
+        std::cout << e.what() << "\n";
+        failures++;
+    }
+
+    kill(peer, SIGKILL);
+    waitpid(peer, nullptr, 0);
+    std::filesystem::remove_all(directory);
+
+    std::cout << (failures == 0 ? "All cluster tests passed ✓" : std::to_string(failures) + " cluster tests failed ✗") << "\n";
+    return failures == 0 ? 0 : 1;
+}
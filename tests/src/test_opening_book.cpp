@@ -0,0 +1,98 @@
+#include "Thera/Board.hpp"
+#include "Thera/Move.hpp"
+#include "Thera/MoveGenerator.hpp"
+#include "Thera/OpeningBook.hpp"
+
+#include "Thera/Utils/ChessTerms.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+
+static int testEntryIO(){
+    Thera::OpeningBook::Entry entry;
+    entry.key = 0x0102030405060708;
+    entry.move = 0x090A;
+    entry.weight = 0x0B0C;
+    entry.learn = 0x0D0E0F10;
+
+    std::stringstream stream;
+    Thera::OpeningBook::writeEntry(stream, entry);
+    const std::string bytes = stream.str();
+    // entries are big-endian
+    for (size_t i=0; i<bytes.size(); i++){
+        if (bytes.at(i) != char(i+1) || bytes.size() != Thera::OpeningBook::entrySize){
+            std::cout << "The entry wasn't written big-endian\n";
+            return 1;
+        }
+    }
+
+    Thera::OpeningBook::Entry read;
+    if (!Thera::OpeningBook::readEntry(stream, read) || read.key != entry.key || read.move != entry.move || read.weight != entry.weight || read.learn != entry.learn){
+        std::cout << "The entry couldn't be read back\n";
+        return 1;
+    }
+    return 0;
+}
+
+static int testSorted(std::string const& path){
+    std::ifstream file(path, std::ios::binary);
+    Thera::OpeningBook::Entry entry, previous;
+    uint64_t numEntries = 0;
+    while (Thera::OpeningBook::readEntry(file, entry)){
+        if (numEntries++ && entry.key < previous.key){
+            std::cout << "The book isn't sorted by key\n";
+            return 1;
+        }
+        previous = entry;
+    }
+    return 0;
+}
+
+/**
+ * @brief Compare the book moves of a position with the expected SAN moves and weights.
+ */
+static int testPosition(Thera::OpeningBook& book, std::vector<std::string> const& sanMoves, std::map<std::string, uint16_t> const& expected){
+    Thera::Board board;
+    Thera::MoveGenerator generator;
+    board.loadFromFEN(Thera::Utils::startingFEN);
+    for (auto const& san : sanMoves){
+        board.applyMove(Thera::Move::fromSAN(san, board));
+    }
+
+    std::map<std::string, uint16_t> actual;
+    for (auto const& [move, weight] : book.getMoves(board, generator)){
+        actual[move.toSAN(board, generator)] = weight;
+    }
+    if (actual == expected) return 0;
+
+    std::cout << "Unexpected book moves in " << board.storeToFEN() << ":";
+    for (auto const& [san, weight] : actual) std::cout << " " << san << "=" << weight;
+    std::cout << "\n";
+    return 1;
+}
+
+// checks the book built from tests/data/book.pgn
+int main(int argc, const char** argv){
+    if (argc != 2){
+        std::cout << "Usage: " << argv[0] << " [book.bin]\n";
+        return 1;
+    }
+
+    int failures = testEntryIO();
+    failures += testSorted(argv[1]);
+
+    Thera::OpeningBook book;
+    book.open(argv[1]);
+    // the weight is 2 per win and 1 per draw, moves that never scored are left out
+    failures += testPosition(book, {}, {{"e4", 2}, {"d4", 1}});
+    failures += testPosition(book, {"e4"}, {{"c5", 2}});
+    failures += testPosition(book, {"e4", "e5"}, {{"Nf3", 2}});
+    failures += testPosition(book, {"d4"}, {{"d5", 1}});
+
+    std::cout << (failures == 0 ? "All opening book tests passed ✓" : std::to_string(failures) + " opening book tests failed ✗") << "\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,197 @@
+#include "Thera/Board.hpp"
+#include "Thera/Move.hpp"
+#include "Thera/MoveGenerator.hpp"
+
+#include "Thera/Utils/ScopeGuard.hpp"
+#include "Thera/Utils/ChessTerms.hpp"
+
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+static bool isSameMove(Thera::Move const& a, Thera::Move const& b){
+    return a == b
+        && a.piece == b.piece
+        && a.isCastling == b.isCastling
+        && a.isEnPassant == b.isEnPassant
+        && a.isDoublePawnMove == b.isDoublePawnMove;
+}
+
+/**
+ * @brief Parse the simple SAN forms for every target square and compare the result with the legal moves.
+ * 
+ * Piece moves ("Nf3"), pawn pushes ("e4"), pawn captures ("exd5") and castling have to be accepted
+ * exactly if one legal move matches them. Promotions are covered by the round trip.
+ * 
+ * @return int the number of failures
+ */
+static int testAllSANs(Thera::Board& board, std::vector<Thera::Move> const& moves){
+    int failures = 0;
+    const auto check = [&](std::string const& san, auto const& matches){
+        std::vector<Thera::Move> expected;
+        for (auto const& move : moves){
+            if (matches(move)) expected.push_back(move);
+        }
+
+        try{
+            const auto parsed = Thera::Move::fromSAN(san, board);
+            if (expected.size() != 1 || !isSameMove(parsed, expected.front())){
+                std::cout << "\"" << san << "\" was parsed as " << parsed.toString() << ", but matches " << expected.size() << " legal moves in " << board.storeToFEN() << "\n";
+                failures++;
+            }
+        }
+        catch(std::invalid_argument const& e){
+            if (expected.size() == 1){
+                std::cout << "\"" << san << "\" was rejected (" << e.what() << ") in " << board.storeToFEN() << "\n";
+                failures++;
+            }
+        }
+    };
+
+    const std::vector<std::pair<char, Thera::PieceType>> pieceLetters = {
+        {'N', Thera::PieceType::Knight}, {'B', Thera::PieceType::Bishop}, {'R', Thera::PieceType::Rook}, {'Q', Thera::PieceType::Queen}, {'K', Thera::PieceType::King},
+    };
+    for (uint8_t target=0; target<64; target++){
+        const Thera::Square targetSquare(target);
+        const std::string targetName = Thera::Utils::squareToAlgebraicNotation(targetSquare);
+
+        for (auto const& [letter, type] : pieceLetters){
+            check(letter + targetName, [&](Thera::Move const& move){ return move.piece.type == type && !move.isCastling && move.endIndex == targetSquare; });
+        }
+
+        if (targetSquare.getRank() == 0 || targetSquare.getRank() == 7) continue;
+        check(targetName, [&](Thera::Move const& move){
+            return move.piece.type == Thera::PieceType::Pawn && move.endIndex == targetSquare && move.startIndex.getFile() == targetSquare.getFile();
+        });
+        for (uint8_t file=0; file<8; file++){
+            check(std::string(1, char('a' + file)) + "x" + targetName, [&](Thera::Move const& move){
+                return move.piece.type == Thera::PieceType::Pawn && move.endIndex == targetSquare && move.startIndex.getFile() == file && file != targetSquare.getFile();
+            });
+        }
+    }
+
+    check("O-O", [](Thera::Move const& move){ return move.isCastling && move.endIndex.getFile() > move.startIndex.getFile(); });
+    check("O-O-O", [](Thera::Move const& move){ return move.isCastling && move.endIndex.getFile() < move.startIndex.getFile(); });
+    return failures;
+}
+
+// convert every legal move to SAN and back, recursing to the given depth
+static int testRoundTrip(Thera::Board& board, Thera::MoveGenerator& generator, int depth){
+    if (depth == 0) return 0;
+
+    int failures = 0;
+    const auto moves = generator.generateAllMoves(board);
+    failures += testAllSANs(board, moves);
+    std::set<std::string> seenSANs;
+    for (auto const& move : moves){
+        const std::string san = move.toSAN(board, generator);
+        if (!seenSANs.insert(san).second){
+            std::cout << "Duplicate SAN \"" << san << "\" in " << board.storeToFEN() << "\n";
+            failures++;
+        }
+
+        try{
+            const auto parsed = Thera::Move::fromSAN(san, board);
+            if (!isSameMove(parsed, move)){
+                std::cout << move.toString() << " -> \"" << san << "\" -> " << parsed.toString() << " in " << board.storeToFEN() << "\n";
+                failures++;
+            }
+        }
+        catch(std::invalid_argument const& e){
+            std::cout << e.what() << " in " << board.storeToFEN() << "\n";
+            failures++;
+        }
+
+        board.applyMove(move);
+        Thera::Utils::ScopeGuard moveRewind_guard([&](){board.rewindMove();});
+        failures += testRoundTrip(board, generator, depth-1);
+    }
+    return failures;
+}
+
+static int testExpectedSAN(std::string const& fen, std::string const& longAlgebraic, std::string const& expectedSAN){
+    Thera::Board board;
+    Thera::MoveGenerator generator;
+    board.loadFromFEN(fen);
+
+    for (auto const& move : generator.generateAllMoves(board)){
+        if (move.toString() != longAlgebraic) continue;
+
+        const std::string san = move.toSAN(board, generator);
+        if (san != expectedSAN){
+            std::cout << longAlgebraic << " should be \"" << expectedSAN << "\", but was \"" << san << "\" in " << fen << "\n";
+            return 1;
+        }
+        return 0;
+    }
+    std::cout << longAlgebraic << " wasn't generated in " << fen << "\n";
+    return 1;
+}
+
+static int testRejectedSAN(std::string const& fen, std::string const& san){
+    Thera::Board board;
+    Thera::MoveGenerator generator;
+    board.loadFromFEN(fen);
+
+    try{
+        const auto parsed = Thera::Move::fromSAN(san, board);
+        std::cout << "\"" << san << "\" should be rejected, but was parsed as " << parsed.toString() << " in " << fen << "\n";
+        return 1;
+    }
+    catch(std::invalid_argument const&){
+        return 0;
+    }
+}
+
+int main(){
+    const std::vector<std::string> fens = {
+        Thera::Utils::startingFEN,
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+        "5K2/P6P/1r4P1/2P4N/1b2q3/p6Q/2pP4/3k4 w - - 0 1",
+    };
+
+    int failures = 0;
+
+    Thera::Board board;
+    Thera::MoveGenerator generator;
+    for (auto const& fen : fens){
+        board.loadFromFEN(fen);
+        failures += testRoundTrip(board, generator, 2);
+    }
+
+    failures += testExpectedSAN(Thera::Utils::startingFEN, "g1f3", "Nf3");
+    failures += testExpectedSAN(Thera::Utils::startingFEN, "e2e4", "e4");
+    failures += testExpectedSAN("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", "e1c1", "O-O-O");
+    failures += testExpectedSAN("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", "e2a6", "Bxa6");
+    failures += testExpectedSAN("rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", "d7c8q", "dxc8=Q");
+    failures += testExpectedSAN("7k/8/8/8/8/8/8/R4RK1 w - - 0 1", "a1d1", "Rad1");
+    failures += testExpectedSAN("7k/8/8/8/R7/8/8/R3K3 w - - 0 1", "a1a2", "R1a2");
+    failures += testExpectedSAN("k7/8/8/8/8/8/8/1N1NK3 w - - 0 1", "b1c3", "Nbc3");
+    failures += testExpectedSAN("7k/8/8/8/Q1Q5/8/Q7/4K3 w - - 0 1", "a4b3", "Qa4b3");
+    // the knight on d2 is pinned, so no disambiguation is needed
+    failures += testExpectedSAN("4r2k/8/8/8/8/8/4N3/2N1K3 w - - 0 1", "c1d3", "Nd3");
+    failures += testExpectedSAN("6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1", "a1a8", "Ra8#");
+    failures += testExpectedSAN("8/8/8/2k5/3Pp3/8/8/4K3 b - d3 0 1", "e4d3", "exd3");
+
+    // capture of an empty square
+    failures += testRejectedSAN("rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1", "exd5");
+    failures += testRejectedSAN("rnbqkbnr/pppp1ppp/8/4p3/4P3/8/PPPP1PPP/RNBQKBNR w KQkq - 0 2", "exd5");
+    // castling through own pieces and through an attacked square
+    failures += testRejectedSAN(Thera::Utils::startingFEN, "O-O");
+    failures += testRejectedSAN("4k3/8/8/8/8/8/8/RN2K2R w KQ - 0 1", "O-O-O");
+    failures += testRejectedSAN("3rk3/8/8/8/8/8/8/R3K2R w KQ - 0 1", "O-O-O");
+    // double push onto an occupied square
+    failures += testRejectedSAN("rnbqkbnr/pppp1ppp/8/8/4p3/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", "e4");
+    // the only candidate is pinned
+    failures += testRejectedSAN("4r2k/8/8/8/8/8/4B3/4K3 w - - 0 1", "Bd3");
+    // leaving the king in check
+    failures += testRejectedSAN("4r2k/8/8/8/8/8/8/N3K3 w - - 0 1", "Nb3");
+
+    std::cout << (failures == 0 ? "All SAN tests passed ✓" : std::to_string(failures) + " SAN tests failed ✗") << "\n";
+    return failures == 0 ? 0 : 1;
+}
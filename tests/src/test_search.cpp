@@ -0,0 +1,42 @@
+#include "Thera/Board.hpp"
+#include "Thera/MoveGenerator.hpp"
+#include "Thera/TranspositionTable.hpp"
+#include "Thera/search.hpp"
+
+#include "Thera/Utils/ChessTerms.hpp"
+
+#include <iostream>
+#include <string>
+#include <atomic>
+#include <algorithm>
+
+static Thera::SearchResult searchPosition(std::string const& fen, int depth){
+    Thera::Board board;
+    board.loadFromFEN(fen);
+    Thera::MoveGenerator generator;
+    Thera::TranspositionTable transpositionTable(1);
+    std::atomic<bool> searchWasTerminated = false;
+    return Thera::search(board, generator, transpositionTable, depth, {}, searchWasTerminated, [](Thera::SearchResult const&){});
+}
+
+// the reported max eval has to be the one of the last finished iteration
+int main(){
+    int failures = 0;
+
+    const auto quiet = searchPosition(Thera::Utils::startingFEN, 3);
+    const int bestEval = std::max_element(quiet.moves.begin(), quiet.moves.end(), [](auto const& a, auto const& b){ return a.eval < b.eval; })->eval;
+    if (quiet.isMate || quiet.depthReached != 3 || quiet.maxEval != bestEval){
+        std::cout << "Wrong result in the starting position: depth " << quiet.depthReached << ", max eval " << quiet.maxEval << ", best move eval " << bestEval << "\n";
+        failures++;
+    }
+
+    // Qh5xf7 is mate, so the search ends early
+    const auto mate = searchPosition("r1bqkbnr/pppp1ppp/2n5/4p2Q/2B1P3/8/PPPP1PPP/RNB1K1NR w KQkq - 4 4", 5);
+    if (!mate.isMate || mate.depthReached == 5 || mate.maxEval != Thera::evalInfinity){
+        std::cout << "The mate wasn't found: depth " << mate.depthReached << ", max eval " << mate.maxEval << "\n";
+        failures++;
+    }
+
+    std::cout << (failures == 0 ? "All search tests passed ✓" : std::to_string(failures) + " search tests failed ✗") << "\n";
+    return failures == 0 ? 0 : 1;
+}
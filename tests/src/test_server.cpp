@@ -0,0 +1,148 @@
+#include <iostream>
+#include <string>
+#include <optional>
+#include <filesystem>
+#include <thread>
+#include <chrono>
+#include <cstring>
+
+#include <unistd.h>
+#include <signal.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+static constexpr auto timeout = std::chrono::seconds(30);
+
+class Connection{
+    public:
+        Connection(std::string const& socketPath){
+            sockaddr_un address{};
+            address.sun_family = AF_UNIX;
+            std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+            // the server may still be starting up
+            const auto start = std::chrono::steady_clock::now();
+            while (std::chrono::steady_clock::now() - start < timeout){
+                socketFD = socket(AF_UNIX, SOCK_STREAM, 0);
+                if (connect(socketFD, reinterpret_cast<sockaddr const*>(&address), sizeof(address)) == 0) return;
+                ::close(socketFD);
+                socketFD = -1;
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+        }
+        Connection(Connection const&) = delete;
+        Connection& operator = (Connection const&) = delete;
+        ~Connection(){
+            if (socketFD != -1) ::close(socketFD);
+        }
+
+        bool isConnected() const { return socketFD != -1; }
+
+        void send(std::string const& text){
+            if (write(socketFD, text.data(), text.size()) != ssize_t(text.size())) std::cout << "Unable to send \"" << text << "\"\n";
+        }
+
+        std::optional<std::string> readLine(){
+            while (true){
+                const size_t end = buffer.find('\n');
+                if (end != std::string::npos){
+                    const std::string line = buffer.substr(0, end);
+                    buffer.erase(0, end + 1);
+                    return line;
+                }
+
+                pollfd pollFD{socketFD, POLLIN, 0};
+                if (poll(&pollFD, 1, std::chrono::milliseconds(timeout).count()) <= 0) return {};
+                char data[4096];
+                const ssize_t size = read(socketFD, data, sizeof(data));
+                if (size <= 0) return {};
+                buffer.append(data, size);
+            }
+        }
+
+    private:
+        int socketFD = -1;
+        std::string buffer;
+};
+
+/**
+ * @brief Read the answers to a search followed by isready.
+ *
+ * @return int the number of failures
+ */
+static int expectSingleBestMove(Connection& connection, std::string const& name){
+    int numBestMoves = 0;
+    while (true){
+        const auto line = connection.readLine();
+        if (!line.has_value()){
+            std::cout << name << ": connection closed or timed out\n";
+            return 1;
+        }
+        if (line->starts_with("error")){
+            std::cout << name << ": " << *line << "\n";
+            return 1;
+        }
+        if (line->starts_with("bestmove")){
+            numBestMoves++;
+            if (numBestMoves == 1) connection.send("isready\n");
+        }
+        if (*line == "readyok") break;
+    }
+    if (numBestMoves != 1){
+        std::cout << name << ": got " << numBestMoves << " best moves\n";
+        return 1;
+    }
+    return 0;
+}
+
+// two sessions searching at the same time must each get exactly one answer
+int main(int argc, const char** argv){
+    if (argc != 2){
+        std::cout << "Usage: " << argv[0] << " [thera-server path]\n";
+        return 1;
+    }
+    const std::string socketPath = (std::filesystem::temp_directory_path() / ("thera-test-server-" + std::to_string(getpid()) + ".sock")).string();
+
+    const pid_t server = fork();
+    if (server == -1){
+        std::cout << "Unable to start the server\n";
+        return 1;
+    }
+    if (server == 0){
+        execl(argv[1], argv[1], "--workers", "2", socketPath.c_str(), nullptr);
+        std::cout << "Unable to run " << argv[1] << ": " << strerror(errno) << "\n";
+        _exit(1);
+    }
+
+    int failures = 0;
+    {
+        Connection first(socketPath);
+        Connection second(socketPath);
+        if (!first.isConnected() || !second.isConnected()){
+            std::cout << "Unable to connect to the server\n";
+            failures++;
+        }
+        else{
+            first.send("position startpos\ngo depth 3\n");
+            second.send("position startpos moves e2e4 e7e5\ngo depth 3\n");
+            failures += expectSingleBestMove(first, "First session");
+            failures += expectSingleBestMove(second, "Second session");
+            first.send("quit\n");
+            second.send("quit\n");
+        }
+    }
+
+    kill(server, SIGTERM);
+    int status = 0;
+    waitpid(server, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0){
+        std::cout << "The server didn't exit cleanly\n";
+        failures++;
+    }
+    std::filesystem::remove(socketPath);
+
+    std::cout << (failures == 0 ? "All server tests passed ✓" : std::to_string(failures) + " server tests failed ✗") << "\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,54 @@
+#include "Thera/Board.hpp"
+#include "Thera/TranspositionTable.hpp"
+#include "Thera/search.hpp"
+
+#include "Thera/Utils/ChessTerms.hpp"
+
+#include <iostream>
+#include <string>
+#include <stdexcept>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+// two tables mapping the same segment behave like two processes sharing it
+int main(){
+    const std::string name = "/thera-test-shared-tt-" + std::to_string(getpid());
+    int failures = 0;
+
+    try{
+        Thera::TranspositionTable writer(1);
+        Thera::TranspositionTable reader(1);
+        writer.openShared(name, 4);
+        reader.openShared(name, 4);
+
+        Thera::Board board;
+        board.loadFromFEN(Thera::Utils::startingFEN);
+        Thera::NegamaxState nstate{.depth = 5, .alpha = -100, .beta = 100};
+        writer.addEntry(board, 42, nstate);
+
+        Thera::NegamaxState probe{.depth = 5, .alpha = -100, .beta = 100};
+        const auto eval = reader.readPotentialEntry(board, probe);
+        if (eval != 42){
+            std::cout << "The entry written by one table wasn't found in the other\n";
+            failures++;
+        }
+
+        // a different size would place the entries in other buckets
+        Thera::TranspositionTable wrongSize(1);
+        try{
+            wrongSize.openShared(name, 8);
+            std::cout << "Opening with a different size didn't fail\n";
+            failures++;
+        }
+        catch(std::runtime_error const&){}
+    }
+    catch(std::exception const& e){
+        std::cout << e.what() << "\n";
+        failures++;
+    }
+    shm_unlink(name.c_str());
+
+    std::cout << (failures == 0 ? "All shared transposition table tests passed ✓" : std::to_string(failures) + " shared transposition table tests failed ✗") << "\n";
+    return failures == 0 ? 0 : 1;
+}
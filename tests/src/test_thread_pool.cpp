@@ -0,0 +1,70 @@
+#include "Thera/Board.hpp"
+#include "Thera/MoveGenerator.hpp"
+#include "Thera/ThreadPool.hpp"
+#include "Thera/perft.hpp"
+
+#include <iostream>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+int main(){
+    int failures = 0;
+
+    Thera::ThreadPool pool(4);
+
+    // every worker runs a broadcast task exactly once
+    std::vector<std::atomic<int>> runs(pool.getNumThreads());
+    pool.submitToAll([&](int workerIndex){ runs.at(workerIndex)++; });
+    pool.wait();
+    for (size_t i=0; i<runs.size(); i++){
+        if (runs.at(i) != 1){
+            std::cout << "Worker " << i << " ran " << runs.at(i) << " broadcast tasks\n";
+            failures++;
+        }
+    }
+
+    // many short tasks in a row must not get lost between parking and waking
+    std::atomic<int> counter = 0;
+    for (int i=0; i<10000; i++){
+        pool.submit([&](int){ counter++; });
+        if (i % 100 == 0) pool.wait();
+    }
+    pool.wait();
+    if (counter != 10000){
+        std::cout << "Ran " << counter << " of 10000 tasks\n";
+        failures++;
+    }
+
+    // exceptions are passed to the waiting thread
+    pool.submit([](int){ throw std::runtime_error("task failed"); });
+    try{
+        pool.wait();
+        std::cout << "Exception was not rethrown\n";
+        failures++;
+    }
+    catch (std::runtime_error const&){}
+
+    // parallel perft matches the serial version
+    const std::vector<std::string> fens = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    };
+    Thera::MoveGenerator generator;
+    for (auto const& fen : fens){
+        Thera::Board board;
+        board.loadFromFEN(fen);
+
+        pool.resize(3);
+        const auto parallel = Thera::perft(board, 3, true, pool);
+        const auto serial = Thera::perft(board, generator, 3, true);
+        if (parallel.numNodesSearched != serial.numNodesSearched || parallel.moves != serial.moves){
+            std::cout << "Parallel perft differs for " << fen << ": " << parallel.numNodesSearched << " vs. " << serial.numNodesSearched << "\n";
+            failures++;
+        }
+    }
+
+    return failures != 0;
+}